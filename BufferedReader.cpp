@@ -0,0 +1,124 @@
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <string.h>
+
+using namespace std;
+
+/*! This is a reader that takes a file in large blocks instead of asking the stream for every field.
+ *  It also knows how many bytes are left in the file, so lengths read from the file can be checked
+ *  before anything is allocated for them */
+class BufferedReader{
+    //! IFSTREAM: The file that is read
+    ifstream& file;
+    //! VECTOR: The current block of the file
+    std::vector<char> buffer;
+    //! SIZE_T: The position of the next unread byte in the buffer
+    size_t position;
+    //! SIZE_T: The number of valid bytes in the buffer
+    size_t filled;
+    //! SIZE_T: The number of bytes in the file after the buffer
+    size_t left;
+
+    //! Reads the next block of the file into the buffer
+    bool refill(){
+        file.read(buffer.data(), buffer.size());
+        filled = (size_t)file.gcount();
+        position = 0;
+        if(left != (size_t)-1) left -= std::min(left, filled);
+        return filled > 0;
+    }
+
+public:
+    //! SIZE_T: The default size of a block
+    static constexpr size_t BLOCK_SIZE = 1 << 20;
+
+    // SECTION: CONSTRUCTORS------------------------------------------------------------------
+
+    //! Creates a reader that starts at the current position of the file
+    explicit BufferedReader(ifstream& file, size_t block_size = BLOCK_SIZE)
+            : file(file), buffer(block_size), position(0), filled(0), left(0){
+        // Finding out how much of the file is left. Streams that cannot seek are treated as endless
+        std::streampos start = file.tellg();
+        file.seekg(0, ios::end);
+        std::streampos end = file.tellg();
+        if(start < 0 || end < 0){
+            file.clear();
+            left = (size_t)-1;
+        } else {
+            left = (size_t)(end - start);
+        }
+        file.seekg(start);
+    }
+
+    // SECTION: GETTERS AND SETTERS-----------------------------------------------------------
+
+    //! Returns the number of bytes that are not read yet
+    size_t getRemaining() const {
+        return left == (size_t)-1 ? left : left + filled - position;
+    }
+
+    // SECTION: HELPER FUNCTIONS---------------------------------------------------------------
+
+    //! Copies the next size bytes into destination. NOTE: Returns false if the file ends before that
+    bool read(void* destination, size_t size){
+        char* out = static_cast<char*>(destination);
+        while (size > 0) {
+            if(position == filled && !refill()) return false;
+            size_t part = std::min(size, filled - position);
+            memcpy(out, buffer.data() + position, part);
+            position += part;
+            out += part;
+            size -= part;
+        }
+        return true;
+    }
+
+    /*! Reads a string of the given length into text. The string grows only with the bytes that were really read,
+     *  so a wrong length cannot allocate more than the file has. NOTE: Returns false if the file ends before that */
+    bool readString(std::string& text, size_t length){
+        text.clear();
+        while (text.size() < length) {
+            if(position == filled && !refill()) return false;
+            size_t part = std::min(length - text.size(), filled - position);
+            text.append(buffer.data() + position, part);
+            position += part;
+        }
+        return true;
+    }
+
+    //! Moves the file back to the first byte that was not read, so the file can be used after the reader
+    void rewindUnread(){
+        file.clear();
+        file.seekg(-(std::streamoff)(filled - position), ios::cur);
+        position = filled;
+    }
+
+    // SECTION: TESTS-------------------------------------------------------------------------
+
+    /*! Test for reading across blocks:
+     *  - Writes ten ints and a string to a file
+     *  - Reads them back with a block of 7 bytes, so most values are split between two blocks */
+    static void blocksTest(){
+        ofstream out("Reader.dat", ios::out | ios::binary);
+        for (int i = 0; i < 10; ++i) {
+            out.write((char*)&i, sizeof(int));
+        }
+        out.write("Appointment", 11);
+        out.close();
+
+        ifstream in("Reader.dat", ios::in | ios::binary);
+        BufferedReader reader(in, 7);
+        int sum = 0, value = 0;
+        for (int i = 0; i < 10; ++i) {
+            reader.read(&value, sizeof(int));
+            sum += value;
+        }
+        std::string text;
+        reader.readString(text, 11);
+        cout << "Sum of the ints: " << sum << ", text: " << text << endl;
+        cout << "Reading past the end: " << (reader.readString(text, 100) ? "true" : "false") << endl;
+    }
+};
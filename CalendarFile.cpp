@@ -0,0 +1,374 @@
+#include <iostream>
+#include <fstream>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <string.h>
+#include <cstdio>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/*! This is the calendar file format. All numbers are little-endian, so the file is the same on every machine.
+ *  - Header (32 bytes): "PCAL", version, number of meetings, size of a meeting record, size of the string heap
+ *    and a 64 bit FNV-1a checksum of everything after the header
+ *  - Meeting table: one 24 byte record per meeting sorted by date, startHour and endHour:
+ *    date serial (4), startHour minutes (2), endHour minutes (2), name offset and length (4 + 4),
+ *    description offset and length (4 + 4)
+ *  - String heap: every distinct name and description once, each followed by a terminating zero
+ *
+ *  An opened file is mapped into memory and read in place. Opening costs the same for any size of file,
+ *  a date lookup is a binary search over the table and the names are used straight from the heap.
+ *  Records are validated when they are read, so a corrupted file cannot make a read go outside the file */
+class CalendarFile{
+public:
+    //! CHAR: The first four bytes of every calendar file
+    static constexpr char MAGIC[5] = "PCAL";
+    //! UINT32_T: The version written by this code
+    static constexpr uint32_t VERSION = 1;
+    //! SIZE_T: The size of the header
+    static constexpr size_t HEADER_SIZE = 32;
+    //! SIZE_T: The size of one meeting record
+    static constexpr size_t RECORD_SIZE = 24;
+
+    //! Reads a little-endian number of the given size
+    static uint64_t loadLittleEndian(const unsigned char* bytes, int size){
+        uint64_t value = 0;
+        for (int i = size - 1; i >= 0; --i) {
+            value = value << 8 | bytes[i];
+        }
+        return value;
+    }
+
+    //! Writes a little-endian number of the given size
+    static void storeLittleEndian(unsigned char* bytes, uint64_t value, int size){
+        for (int i = 0; i < size; ++i) {
+            bytes[i] = (unsigned char)(value >> (8 * i));
+        }
+    }
+
+    //! Adds bytes to a FNV-1a checksum
+    static uint64_t addToChecksum(uint64_t hash, const unsigned char* bytes, size_t size){
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    //! Makes sure the contents of a file are on the disk
+    static void syncPath(const std::string& path){
+#ifdef _WIN32
+        int file = _open(path.c_str(), _O_RDWR | _O_BINARY);
+        if(file < 0) return;
+        _commit(file);
+        _close(file);
+#else
+        int file = ::open(path.c_str(), O_RDONLY);
+        if(file < 0) return;
+        fsync(file);
+        ::close(file);
+#endif
+    }
+
+    /*! Puts a finished temporary file in the place of path. The file is synced before the rename and the directory
+     *  after it, so after a crash path is either the old file or the new one and never a partly written one.
+     *  NOTE: Throws invalid_argument exception */
+    static void replaceFile(const std::string& temporary, const std::string& path){
+        syncPath(temporary);
+#ifdef _WIN32
+        // Windows cannot rename over an existing file
+        std::remove(path.c_str());
+#endif
+        if(std::rename(temporary.c_str(), path.c_str()) != 0) throw std::invalid_argument( "Couldn't rename " + temporary );
+#ifndef _WIN32
+        size_t slash = path.rfind('/');
+        syncPath(slash == std::string::npos ? "." : path.substr(0, slash + 1));
+#endif
+    }
+
+private:
+    //! UCHAR: The whole mapped file
+    const unsigned char* data;
+    //! SIZE_T: The size of the file
+    size_t fileSize;
+    //! UINT32_T: The number of meetings in the table
+    uint32_t count;
+    //! UCHAR: The start of the meeting table
+    const unsigned char* table;
+    //! CHAR: The start of the string heap
+    const char* heap;
+    //! UINT64_T: The size of the string heap
+    uint64_t heapSize;
+#ifdef _WIN32
+    //! VECTOR: Without mmap the file is read into this buffer
+    std::vector<unsigned char> buffer;
+#endif
+
+    //! Returns the record of a meeting
+    const unsigned char* recordAt(size_t index) const {
+        if(index >= count) throw std::invalid_argument( "The meeting is not in the calendar file" );
+        return table + index * RECORD_SIZE;
+    }
+
+    //! Returns a string from the heap after checking that it is inside the heap and ends with a zero
+    const char* stringAt(const unsigned char* field) const {
+        uint64_t offset = loadLittleEndian(field, 4);
+        uint64_t length = loadLittleEndian(field + 4, 4);
+        if(offset + length >= heapSize || heap[offset + length] != '\0') throw std::invalid_argument( "The calendar file is corrupted" );
+        return heap + offset;
+    }
+
+    //! Returns the sort key of a record in the same form as Meeting::getSortKey()
+    long long keyAt(size_t index) const {
+        const unsigned char* record = table + index * RECORD_SIZE;
+        return (long long)loadLittleEndian(record, 4) << 22
+               | (long long)loadLittleEndian(record + 4, 2) << 11
+               | (long long)loadLittleEndian(record + 6, 2);
+    }
+
+    //! Returns the first record with a sort key that is not smaller than key
+    size_t lowerBound(long long key) const {
+        size_t low = 0, high = count;
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if(keyAt(middle) < key) low = middle + 1;
+            else high = middle;
+        }
+        return low;
+    }
+
+    //! Gives the mapped memory back
+    void close(){
+#ifndef _WIN32
+        if(data != nullptr) munmap((void*)data, fileSize);
+#endif
+        data = nullptr;
+    }
+
+public:
+    // SECTION: CONSTRUCTORS------------------------------------------------------------------
+
+    /*! Opens a calendar file and checks its header. Only the header is read, the rest is mapped
+     *  and read when needed. NOTE: Throws invalid_argument exception if the file is not a valid calendar file */
+    explicit CalendarFile(const char* path) : data(nullptr), fileSize(0), count(0), table(nullptr), heap(nullptr), heapSize(0){
+#ifdef _WIN32
+        ifstream file(path, ios::in | ios::binary | ios::ate);
+        if(!file) throw std::invalid_argument( "Couldn't open file" );
+        fileSize = (size_t)file.tellg();
+        buffer.resize(fileSize);
+        file.seekg(0);
+        file.read((char*)buffer.data(), fileSize);
+        data = buffer.data();
+#else
+        int descriptor = ::open(path, O_RDONLY);
+        if(descriptor < 0) throw std::invalid_argument( "Couldn't open file" );
+        struct stat info;
+        if(fstat(descriptor, &info) != 0){
+            ::close(descriptor);
+            throw std::invalid_argument( "Couldn't open file" );
+        }
+        fileSize = (size_t)info.st_size;
+        if(fileSize >= HEADER_SIZE){
+            void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if(mapped != MAP_FAILED) data = (const unsigned char*)mapped;
+        }
+        ::close(descriptor);
+        if(data == nullptr && fileSize >= HEADER_SIZE) throw std::invalid_argument( "Couldn't map file" );
+#endif
+
+        // Checking the header
+        if(fileSize < HEADER_SIZE || memcmp(data, MAGIC, 4) != 0){
+            close();
+            throw std::invalid_argument( "The file is not a calendar file" );
+        }
+        if(loadLittleEndian(data + 4, 4) != VERSION || loadLittleEndian(data + 12, 4) != RECORD_SIZE){
+            close();
+            throw std::invalid_argument( "The calendar file version is not supported" );
+        }
+        count = (uint32_t)loadLittleEndian(data + 8, 4);
+        heapSize = loadLittleEndian(data + 16, 8);
+        if(HEADER_SIZE + (uint64_t)count * RECORD_SIZE + heapSize != fileSize){
+            close();
+            throw std::invalid_argument( "The calendar file is corrupted" );
+        }
+        table = data + HEADER_SIZE;
+        heap = (const char*)(table + (size_t)count * RECORD_SIZE);
+    }
+
+    //! The file owns the mapped memory, so it cannot be copied
+    CalendarFile(const CalendarFile &other) = delete;
+    CalendarFile& operator = (const CalendarFile& rhs) = delete;
+
+    //! Destructor for the CalendarFile class
+    ~CalendarFile() {
+        close();
+    }
+
+    /*! Writes meetings to a calendar file. forEachMeeting(action) has to call action(meeting) for every meeting
+     *  sorted by date, startHour and endHour. It is called twice: once to collect the strings and once to write the table.
+     *  The file is written next to path and put in its place with replaceFile(), so a crash never leaves a partly written file.
+     *  NOTE: Throws invalid_argument exception if the file cannot be written */
+    template <typename ForEach>
+    static void write(const char* path, ForEach forEachMeeting){
+        // Giving every distinct string a place in the heap. Equal strings share a handle, so they are found by it
+        std::unordered_map<int, uint32_t> offsets;
+        std::vector<int> strings;
+        uint64_t heap_size = 0;
+        uint64_t meeting_count = 0;
+        auto place = [&](int handle){
+            if(offsets.count(handle) != 0) return;
+            if(heap_size + StringArena::shared().length(handle) + 1 > UINT32_MAX) throw std::invalid_argument( "The strings are too big for a calendar file" );
+            offsets[handle] = (uint32_t)heap_size;
+            strings.push_back(handle);
+            heap_size += StringArena::shared().length(handle) + 1;
+        };
+        forEachMeeting([&](const Meeting& meeting){
+            place(meeting.getNameHandle());
+            place(meeting.getDescriptionHandle());
+            meeting_count++;
+        });
+        if(meeting_count > UINT32_MAX) throw std::invalid_argument( "Too many meetings for a calendar file" );
+
+        std::string temporary = std::string(path) + ".tmp";
+        {
+            ofstream file(temporary, ios::out | ios::binary | ios::trunc);
+            if(!file) throw std::invalid_argument( "Couldn't open file" );
+
+            // The header is written last, when the checksum is known
+            unsigned char header[HEADER_SIZE] = {};
+            file.write((char*)header, HEADER_SIZE);
+
+            uint64_t checksum = 14695981039346656037ULL;
+            forEachMeeting([&](const Meeting& meeting){
+                unsigned char record[RECORD_SIZE];
+                storeLittleEndian(record, meeting.getDate().getSerial(), 4);
+                storeLittleEndian(record + 4, meeting.getStartHour().getTotalMinutes(), 2);
+                storeLittleEndian(record + 6, meeting.getEndHour().getTotalMinutes(), 2);
+                storeLittleEndian(record + 8, offsets[meeting.getNameHandle()], 4);
+                storeLittleEndian(record + 12, StringArena::shared().length(meeting.getNameHandle()), 4);
+                storeLittleEndian(record + 16, offsets[meeting.getDescriptionHandle()], 4);
+                storeLittleEndian(record + 20, StringArena::shared().length(meeting.getDescriptionHandle()), 4);
+                checksum = addToChecksum(checksum, record, RECORD_SIZE);
+                file.write((char*)record, RECORD_SIZE);
+            });
+            for (int handle : strings) {
+                const unsigned char* text = (const unsigned char*)StringArena::shared().get(handle);
+                size_t length = StringArena::shared().length(handle) + 1;
+                checksum = addToChecksum(checksum, text, length);
+                file.write((const char*)text, length);
+            }
+
+            memcpy(header, MAGIC, 4);
+            storeLittleEndian(header + 4, VERSION, 4);
+            storeLittleEndian(header + 8, meeting_count, 4);
+            storeLittleEndian(header + 12, RECORD_SIZE, 4);
+            storeLittleEndian(header + 16, heap_size, 8);
+            storeLittleEndian(header + 24, checksum, 8);
+            file.seekp(0);
+            file.write((char*)header, HEADER_SIZE);
+            if(!file) throw std::invalid_argument( "Couldn't write file" );
+        }
+        replaceFile(temporary, path);
+    }
+
+    // SECTION: GETTERS AND SETTERS-----------------------------------------------------------
+
+    //! Getter for the number of meetings in the file
+    size_t getCount() const {
+        return count;
+    }
+
+    //! Getter for the date of a meeting. NOTE: Throws invalid_argument exception if the record is corrupted
+    MyDate getDate(size_t index) const {
+        uint64_t serial = loadLittleEndian(recordAt(index), 4);
+        if(serial > (uint64_t)MyDate::MAX_SERIAL) throw std::invalid_argument( "The calendar file is corrupted" );
+        return MyDate::fromSerial((int)serial);
+    }
+
+    //! Getter for the startHour of a meeting. NOTE: Throws invalid_argument exception if the record is corrupted
+    MyHour getStartHour(size_t index) const {
+        uint64_t minutes = loadLittleEndian(recordAt(index) + 4, 2);
+        if(minutes >= (uint64_t)MyHour::MINUTES_IN_DAY) throw std::invalid_argument( "The calendar file is corrupted" );
+        return MyHour::fromMinutes((int)minutes);
+    }
+
+    //! Getter for the endHour of a meeting. NOTE: Throws invalid_argument exception if the record is corrupted
+    MyHour getEndHour(size_t index) const {
+        uint64_t minutes = loadLittleEndian(recordAt(index) + 6, 2);
+        if(minutes >= (uint64_t)MyHour::MINUTES_IN_DAY) throw std::invalid_argument( "The calendar file is corrupted" );
+        return MyHour::fromMinutes((int)minutes);
+    }
+
+    //! Getter for the name of a meeting. The text is read in place and is valid while the file is open
+    const char* getName(size_t index) const {
+        return stringAt(recordAt(index) + 8);
+    }
+
+    //! Getter for the description of a meeting. The text is read in place and is valid while the file is open
+    const char* getDescription(size_t index) const {
+        return stringAt(recordAt(index) + 16);
+    }
+
+    //! Returns a copy of a meeting that can be added to a calendar
+    Meeting getMeeting(size_t index) const {
+        return Meeting((char*)getName(index), (char*)getDescription(index), getDate(index), getStartHour(index), getEndHour(index));
+    }
+
+    // SECTION: HELPER FUNCTIONS---------------------------------------------------------------
+
+    //! Returns the index of the first meeting on the given date or later
+    size_t dateBegin(const MyDate& date) const {
+        return lowerBound(Meeting::getDateKey(date));
+    }
+
+    //! Returns the index of the first meeting after the given date
+    size_t dateEnd(const MyDate& date) const {
+        return lowerBound(Meeting::getDateKey(date) + (1 << 22));
+    }
+
+    //! Returns the number of meetings on a given date
+    size_t countByDate(const MyDate& date) const {
+        return dateEnd(date) - dateBegin(date);
+    }
+
+    /*! Checks the checksum of the whole file. It reads every byte, so it is not done when the file is opened.
+     *  NOTE: Returns false if the file was changed or damaged after it was written */
+    bool verify() const {
+        uint64_t checksum = addToChecksum(14695981039346656037ULL, table, fileSize - HEADER_SIZE);
+        return checksum == loadLittleEndian(data + 24, 8);
+    }
+
+    // SECTION: TESTS-------------------------------------------------------------------------
+
+    /*! Test for writing and reading a calendar file:
+     *  - Writes three meetings where two of them have the same description
+     *  - Opens the file and reads the meetings of one date in place */
+    static void writeAndReadTest(){
+        std::vector<Meeting> meetings;
+        meetings.push_back(Meeting((char*)"Lunch", (char*)"Lunch with the team", MyDate(22, 10, 2022), MyHour(12, 0), MyHour(13, 0)));
+        meetings.push_back(Meeting((char*)"Appointment", (char*)"Appointment with the doctor", MyDate(23, 10, 2022), MyHour(9, 0), MyHour(10, 0)));
+        meetings.push_back(Meeting((char*)"Dinner", (char*)"Lunch with the team", MyDate(23, 10, 2022), MyHour(19, 0), MyHour(21, 0)));
+        CalendarFile::write("Calendar.pcal", [&](auto action){
+            for (const Meeting& meeting : meetings) {
+                action(meeting);
+            }
+        });
+
+        CalendarFile file("Calendar.pcal");
+        cout << "Meetings in the file: " << file.getCount() << ", checksum is valid: " << (file.verify() ? "true" : "false") << endl;
+        cout << "Meetings on 2022-10-23:" << endl;
+        for (size_t i = file.dateBegin(MyDate(23, 10, 2022)); i < file.dateEnd(MyDate(23, 10, 2022)); ++i) {
+            cout << file.getName(i) << " - " << file.getDescription(i) << endl;
+        }
+    }
+};
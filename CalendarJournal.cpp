@@ -0,0 +1,544 @@
+#include <iostream>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/*! This is a calendar that is kept on disk as a snapshot plus an append-only journal of the changes made after it.
+ *  A change costs as much I/O as the change itself instead of rewriting the whole calendar.
+ *  - Snapshot: base.N.pcal in the CalendarFile format. base.manifest keeps the number N of the last complete one
+ *  - Journal: base.N.journal has the changes made after snapshot N. Every record is
+ *    payload length (4), FNV-1a checksum of the payload (4) and the payload, all little-endian
+ *
+ *  Changes are collected in memory and written by commit(). When many threads commit at the same time,
+ *  the first one writes and syncs everything collected so far and the others only wait for it (group commit),
+ *  so many commits share a single fsync. checkpoint() starts a new journal and builds and writes the next snapshot
+ *  in a background thread from the files of the last one, so the calendar is never copied under the lock. Opening the calendar loads the last snapshot and replays the journals after it.
+ *  A record that was cut by a crash fails its checksum, so it and everything after it are dropped */
+class CalendarJournal{
+    //! The kinds of changes in the journal
+    enum Operation : unsigned char{
+        ADD = 1,
+        REMOVE = 2,
+        UPDATE_BY_NAME = 3,
+        UPDATE_BY_DATE_AND_HOUR = 4
+    };
+
+    //! Reads the fields of a record and remembers if it went past the end
+    struct Cursor{
+        //! UCHAR: The next unread byte
+        const unsigned char* at;
+        //! UCHAR: The end of the record
+        const unsigned char* end;
+        //! BOOL: False after a read that did not fit in the record
+        bool valid;
+
+        //! Reads a little-endian number of the given size
+        uint64_t number(int size){
+            if(end - at < size){
+                valid = false;
+                return 0;
+            }
+            uint64_t value = CalendarFile::loadLittleEndian(at, size);
+            at += size;
+            return value;
+        }
+
+        //! Reads a string written with its length first
+        std::string text(){
+            uint64_t length = number(4);
+            if((uint64_t)(end - at) < length){
+                valid = false;
+                return std::string();
+            }
+            std::string value((const char*)at, length);
+            at += length;
+            return value;
+        }
+
+        //! Reads a meeting. Invalid dates and hours make the cursor invalid
+        Meeting meeting(){
+            uint64_t serial = number(4);
+            uint64_t start = number(2);
+            uint64_t end_minutes = number(2);
+            std::string name = text();
+            std::string description = text();
+            if(serial > (uint64_t)MyDate::MAX_SERIAL || start >= (uint64_t)MyHour::MINUTES_IN_DAY
+               || end_minutes >= (uint64_t)MyHour::MINUTES_IN_DAY){
+                valid = false;
+            }
+            if(!valid) return Meeting();
+            return Meeting(&name[0], &description[0], MyDate::fromSerial((int)serial),
+                           MyHour::fromMinutes((int)start), MyHour::fromMinutes((int)end_minutes));
+        }
+    };
+
+    //! STRING: The start of the paths of all files
+    std::string base;
+    //! PERSONALCALENDAR: The calendar with all changes applied
+    PersonalCalendar calendar;
+    //! MUTEX: Guards everything below and the calendar
+    std::mutex lock;
+    //! CONDITION_VARIABLE: Wakes the threads that wait for a commit or a checkpoint rotation
+    std::condition_variable synced;
+    //! STRING: The encoded records that are not written yet
+    std::string pending;
+    //! UNSIGNED LONG LONG: The number of records added to pending since the calendar was opened
+    unsigned long long appended;
+    //! UNSIGNED LONG LONG: The number of records that are written and synced
+    unsigned long long durable;
+    //! BOOL: Whether a thread is writing and syncing right now
+    bool flushing;
+    //! INT: The descriptor of the current journal
+    int descriptor;
+    //! UNSIGNED LONG LONG: The number of the current journal and the snapshot it is applied to
+    unsigned long long generation;
+    //! MUTEX: Guards the three members below. Held by checkpoint() from start to end, so checkpoints run one at a time
+    std::mutex checkpointLock;
+    //! CONDITION_VARIABLE: Wakes the threads that wait for the checkpoint thread to finish
+    std::condition_variable checkpointDone;
+    //! BOOL: Whether the checkpoint thread is still writing the snapshot
+    bool checkpointRunning;
+    //! THREAD: The thread that writes the last snapshot
+    std::thread checkpointThread;
+    //! EXCEPTION_PTR: The error of the last checkpoint thread. Set by the thread when it finishes
+    std::exception_ptr checkpointError;
+
+    // SECTION: FILE HELPERS------------------------------------------------------------------
+
+    //! Returns the path of the snapshot or the journal with the given number
+    std::string pathOf(unsigned long long number, const char* extension) const {
+        return base + "." + std::to_string(number) + extension;
+    }
+
+    //! Opens a file for appending. NOTE: Throws invalid_argument exception
+    static int openForAppend(const std::string& path){
+#ifdef _WIN32
+        int result = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, 0644);
+#else
+        int result = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+        if(result < 0) throw std::invalid_argument( "Couldn't open the journal" );
+        return result;
+    }
+
+    //! Writes the whole buffer and syncs it to the disk. NOTE: Throws invalid_argument exception
+    static void writeAndSync(int file, const std::string& bytes){
+        size_t written = 0;
+        while (written < bytes.size()) {
+#ifdef _WIN32
+            int result = _write(file, bytes.data() + written, (unsigned)(bytes.size() - written));
+#else
+            ssize_t result = ::write(file, bytes.data() + written, bytes.size() - written);
+#endif
+            if(result <= 0) throw std::invalid_argument( "Couldn't write the journal" );
+            written += (size_t)result;
+        }
+        syncFile(file);
+    }
+
+    //! Makes sure everything written to the file is on the disk
+    static void syncFile(int file){
+#ifdef _WIN32
+        _commit(file);
+#else
+        fsync(file);
+#endif
+    }
+
+    //! Closes a file descriptor
+    static void closeFile(int file){
+#ifdef _WIN32
+        _close(file);
+#else
+        ::close(file);
+#endif
+    }
+
+    //! Checks if a file exists
+    static bool exists(const std::string& path){
+        ifstream file(path, ios::in | ios::binary);
+        return (bool)file;
+    }
+
+    // SECTION: RECORD HELPERS----------------------------------------------------------------
+
+    //! Adds a little-endian number of the given size to a record
+    static void putNumber(std::string& record, uint64_t value, int size){
+        unsigned char bytes[8];
+        CalendarFile::storeLittleEndian(bytes, value, size);
+        record.append((const char*)bytes, size);
+    }
+
+    //! Adds a string with its length first to a record
+    static void putText(std::string& record, const char* text){
+        size_t length = strlen(text);
+        putNumber(record, length, 4);
+        record.append(text, length);
+    }
+
+    //! Adds a meeting to a record
+    static void putMeeting(std::string& record, const Meeting& meeting){
+        putNumber(record, meeting.getDate().getSerial(), 4);
+        putNumber(record, meeting.getStartHour().getTotalMinutes(), 2);
+        putNumber(record, meeting.getEndHour().getTotalMinutes(), 2);
+        putText(record, meeting.getName());
+        putText(record, meeting.getDescription());
+    }
+
+    //! Adds a finished payload to the pending records with its length and checksum. The lock has to be held
+    void append(const std::string& payload){
+        putNumber(pending, payload.size(), 4);
+        putNumber(pending, (uint32_t)CalendarFile::addToChecksum(14695981039346656037ULL, (const unsigned char*)payload.data(), payload.size()), 4);
+        pending += payload;
+        appended++;
+    }
+
+    //! Applies a single payload to a calendar. NOTE: Returns false if the payload is not valid
+    static bool apply(PersonalCalendar& calendar, const unsigned char* payload, size_t size){
+        Cursor cursor = {payload, payload + size, true};
+        Operation operation = (Operation)cursor.number(1);
+        if(operation == ADD || operation == REMOVE){
+            Meeting meeting = cursor.meeting();
+            if(!cursor.valid || cursor.at != cursor.end) return false;
+            if(operation == ADD) calendar.addMeeting(std::move(meeting));
+            else calendar.removeMeeting(meeting);
+        } else if(operation == UPDATE_BY_NAME){
+            std::string name = cursor.text();
+            Meeting meeting = cursor.meeting();
+            if(!cursor.valid || cursor.at != cursor.end) return false;
+            calendar.updateAllWithName(&name[0], meeting);
+        } else if(operation == UPDATE_BY_DATE_AND_HOUR){
+            uint64_t serial = cursor.number(4);
+            uint64_t start = cursor.number(2);
+            Meeting meeting = cursor.meeting();
+            if(!cursor.valid || cursor.at != cursor.end || serial > (uint64_t)MyDate::MAX_SERIAL
+               || start >= (uint64_t)MyHour::MINUTES_IN_DAY) return false;
+            calendar.updateAllByDateAndHour(MyDate::fromSerial((int)serial), MyHour::fromMinutes((int)start), meeting);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    /*! Applies all valid records of a journal to a calendar.
+     *  NOTE: Returns the size of the valid part. Everything after it was cut by a crash */
+    static size_t replay(PersonalCalendar& calendar, const std::string& path){
+        ifstream file(path, ios::in | ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const unsigned char* data = (const unsigned char*)bytes.data();
+        size_t position = 0;
+        while (bytes.size() - position >= 8) {
+            uint64_t size = CalendarFile::loadLittleEndian(data + position, 4);
+            uint64_t checksum = CalendarFile::loadLittleEndian(data + position + 4, 4);
+            if(size > bytes.size() - position - 8) break;
+            const unsigned char* payload = data + position + 8;
+            if((uint32_t)CalendarFile::addToChecksum(14695981039346656037ULL, payload, size) != checksum) break;
+            if(!apply(calendar, payload, size)) break;
+            position += 8 + size;
+        }
+        return position;
+    }
+
+    //! Returns the number of the snapshot that the manifest points to. NOTE: Returns 0 if there is no snapshot yet
+    unsigned long long manifestGeneration() const {
+        unsigned long long number = 0;
+        ifstream manifest(base + ".manifest");
+        if(manifest) manifest >> number;
+        return number;
+    }
+
+    /*! Builds the calendar as it was when journal number was started. It loads the snapshot of the manifest and
+     *  replays all journals after it, which are complete, because checkpoint() syncs them before it switches journals */
+    PersonalCalendar buildSnapshot(unsigned long long number) const {
+        PersonalCalendar snapshot;
+        unsigned long long first = manifestGeneration();
+        if(first > 0) snapshot.loadFile(pathOf(first, ".pcal").c_str());
+        for (unsigned long long journal = first; journal < number; ++journal) {
+            replay(snapshot, pathOf(journal, ".journal"));
+        }
+        return snapshot;
+    }
+
+    //! Writes a snapshot with the given number, points the manifest to it and deletes all older files
+    void writeSnapshot(const PersonalCalendar& snapshot, unsigned long long number){
+        // saveFile() writes a temporary file and renames it, so the snapshot is never seen half written
+        snapshot.saveFile(pathOf(number, ".pcal").c_str());
+
+        // The manifest is replaced the same way, so it always points to a complete snapshot
+        std::string manifest = base + ".manifest";
+        {
+            ofstream out(manifest + ".tmp", ios::out | ios::trunc);
+            out << number;
+        }
+        CalendarFile::replaceFile(manifest + ".tmp", manifest);
+
+        // A checkpoint that failed leaves its journal, so there can be more than one older generation.
+        // Generations are numbered without gaps, so the first one with no files ends the search
+        for (unsigned long long older = number; older-- > 0; ) {
+            bool found = std::remove(pathOf(older, ".pcal").c_str()) == 0;
+            found = std::remove(pathOf(older, ".journal").c_str()) == 0 || found;
+            found = std::remove(pathOf(older, ".pcal.tmp").c_str()) == 0 || found;
+            if(!found) break;
+        }
+    }
+
+    /*! Waits for the checkpoint thread and throws its error once. checkpointLock has to be held by guard.
+     *  The thread lets checkpointLock go before it ends, so it can be joined while the lock is held */
+    void waitLocked(std::unique_lock<std::mutex>& guard){
+        checkpointDone.wait(guard, [this](){
+            return !checkpointRunning;
+        });
+        if(checkpointThread.joinable()) checkpointThread.join();
+        if(checkpointError){
+            std::exception_ptr error = checkpointError;
+            checkpointError = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    //! Writes and syncs everything pending. The lock has to be held and no other thread may be flushing
+    void flushLocked(){
+        if(!pending.empty()) writeAndSync(descriptor, pending);
+        pending.clear();
+        durable = appended;
+    }
+
+public:
+    // SECTION: CONSTRUCTORS------------------------------------------------------------------
+
+    /*! Opens the calendar kept in files starting with base_path. Loads the last snapshot, replays the journals
+     *  after it and cuts a journal that ends with a broken record. NOTE: Throws invalid_argument exception */
+    explicit CalendarJournal(const char* base_path)
+            : base(base_path), appended(0), durable(0), flushing(false), descriptor(-1), generation(0), checkpointRunning(false){
+        generation = manifestGeneration();
+        if(generation > 0) calendar.loadFile(pathOf(generation, ".pcal").c_str());
+
+        // A checkpoint that did not finish leaves more than one journal
+        unsigned long long last = generation;
+        size_t valid_size = 0;
+        for (unsigned long long number = generation; exists(pathOf(number, ".journal")); ++number) {
+            last = number;
+            valid_size = replay(calendar, pathOf(number, ".journal"));
+        }
+        generation = last;
+
+        std::string journal = pathOf(generation, ".journal");
+        descriptor = openForAppend(journal);
+#ifdef _WIN32
+        _chsize_s(descriptor, (long long)valid_size);
+#else
+        if(ftruncate(descriptor, (off_t)valid_size) != 0) throw std::invalid_argument( "Couldn't cut the journal" );
+#endif
+    }
+
+    //! The calendar owns files, so it cannot be copied
+    CalendarJournal(const CalendarJournal &other) = delete;
+    CalendarJournal& operator = (const CalendarJournal& rhs) = delete;
+
+    //! Destructor for the CalendarJournal class. Commits the pending changes and waits for the checkpoint
+    ~CalendarJournal() {
+        try {
+            commit();
+        } catch (std::invalid_argument&) {
+            // The changes that were not committed are lost, like after a crash
+        }
+        try {
+            waitForCheckpoint();
+        } catch (...) {
+            // The manifest still points to the old snapshot, so the next opening replays the old journals
+        }
+        if(descriptor >= 0) closeFile(descriptor);
+    }
+
+    // SECTION: GETTERS AND SETTERS-----------------------------------------------------------
+
+    //! Calls action(calendar) while no other thread can change the calendar
+    template <typename Action>
+    void read(Action action){
+        std::lock_guard<std::mutex> guard(lock);
+        action((const PersonalCalendar&)calendar);
+    }
+
+    //! Getter for the number of the current journal
+    unsigned long long getGeneration(){
+        std::lock_guard<std::mutex> guard(lock);
+        return generation;
+    }
+
+    // SECTION: HELPER FUNCTIONS---------------------------------------------------------------
+
+    //! Adds a meeting. The change is on the disk after the next commit()
+    void addMeeting(const Meeting& meeting){
+        std::string payload(1, (char)ADD);
+        putMeeting(payload, meeting);
+        std::lock_guard<std::mutex> guard(lock);
+        calendar.addMeeting(meeting);
+        append(payload);
+    }
+
+    //! Removes a meeting. The change is on the disk after the next commit(). NOTE: Returns false if there is no such meeting
+    bool removeMeeting(const Meeting& meeting){
+        std::string payload(1, (char)REMOVE);
+        putMeeting(payload, meeting);
+        std::lock_guard<std::mutex> guard(lock);
+        if(!calendar.removeMeeting(meeting)) return false;
+        append(payload);
+        return true;
+    }
+
+    //! Replaces all meetings with the given name. The change is on the disk after the next commit()
+    void updateAllWithName(char* name, const Meeting& new_meeting){
+        std::string payload(1, (char)UPDATE_BY_NAME);
+        putText(payload, name);
+        putMeeting(payload, new_meeting);
+        std::lock_guard<std::mutex> guard(lock);
+        calendar.updateAllWithName(name, new_meeting);
+        append(payload);
+    }
+
+    //! Replaces all meetings on a date that start at a given hour. The change is on the disk after the next commit()
+    void updateAllByDateAndHour(const MyDate& date, const MyHour& start, const Meeting& new_meeting){
+        std::string payload(1, (char)UPDATE_BY_DATE_AND_HOUR);
+        putNumber(payload, date.getSerial(), 4);
+        putNumber(payload, start.getTotalMinutes(), 2);
+        putMeeting(payload, new_meeting);
+        std::lock_guard<std::mutex> guard(lock);
+        calendar.updateAllByDateAndHour(date, start, new_meeting);
+        append(payload);
+    }
+
+    /*! Makes every change made before the call durable. If another thread is already syncing, this one waits
+     *  for it and syncs only what is left, so concurrent commits share the fsync calls.
+     *  NOTE: Throws invalid_argument exception if the journal cannot be written */
+    void commit(){
+        std::unique_lock<std::mutex> guard(lock);
+        unsigned long long target = appended;
+        while (durable < target) {
+            if(flushing){
+                synced.wait(guard);
+                continue;
+            }
+            // This thread writes everything collected so far for all waiting threads
+            flushing = true;
+            std::string batch;
+            batch.swap(pending);
+            unsigned long long batch_end = appended;
+            int file = descriptor;
+            guard.unlock();
+            try {
+                writeAndSync(file, batch);
+            } catch (std::invalid_argument&) {
+                guard.lock();
+                flushing = false;
+                synced.notify_all();
+                throw;
+            }
+            guard.lock();
+            flushing = false;
+            durable = batch_end;
+            synced.notify_all();
+        }
+    }
+
+    /*! Starts a new journal and writes a snapshot of the calendar in a background thread.
+     *  The lock is held only to sync and switch the journal. The thread builds the snapshot from the files
+     *  with buildSnapshot(), so changes can be made while it is built and written. They go to the new journal.
+     *  NOTE: Only one checkpoint runs at a time, so this waits for the previous one and throws its error
+     *  (see waitForCheckpoint()). Throws invalid_argument exception */
+    void checkpoint(){
+        std::unique_lock<std::mutex> checkpointing(checkpointLock);
+        waitLocked(checkpointing);
+
+        std::unique_lock<std::mutex> guard(lock);
+        while (flushing) {
+            synced.wait(guard);
+        }
+        flushLocked();
+
+        unsigned long long number = generation + 1;
+        int file = openForAppend(pathOf(number, ".journal"));
+        closeFile(descriptor);
+        descriptor = file;
+        generation = number;
+        guard.unlock();
+
+        // The thread lets checkpointRunning go under checkpointLock, so waitLocked() can join it
+        checkpointRunning = true;
+        try {
+            checkpointThread = std::thread([this, number](){
+                std::exception_ptr error;
+                try {
+                    writeSnapshot(buildSnapshot(number), number);
+                } catch (...) {
+                    // The manifest still points to the old snapshot and the old journal is kept, so nothing is lost
+                    error = std::current_exception();
+                }
+                {
+                    std::lock_guard<std::mutex> finishing(checkpointLock);
+                    checkpointError = error;
+                    checkpointRunning = false;
+                }
+                checkpointDone.notify_all();
+            });
+        } catch (...) {
+            checkpointRunning = false;
+            throw;
+        }
+    }
+
+    /*! Waits until the last checkpoint is written.
+     *  NOTE: Throws the error of the checkpoint thread if it failed. The error is thrown once */
+    void waitForCheckpoint(){
+        std::unique_lock<std::mutex> checkpointing(checkpointLock);
+        waitLocked(checkpointing);
+    }
+
+    // SECTION: TESTS-------------------------------------------------------------------------
+
+    /*! Test for the recovery:
+     *  - Adds meetings, commits, makes a checkpoint and adds more meetings
+     *  - Opens the same files again and prints the recovered calendar
+     *  - Adds a broken record at the end of the journal and checks that it is dropped */
+    static void recoveryTest(){
+        std::remove("Journal.manifest");
+        std::remove("Journal.0.journal");
+        std::remove("Journal.1.journal");
+        std::remove("Journal.1.pcal");
+        {
+            CalendarJournal journal("Journal");
+            journal.addMeeting(Meeting((char*)"Anime Convention 1", (char*)"Going to anime convention", MyDate(22, 10, 2022), MyHour(9, 0), MyHour(15, 0)));
+            journal.addMeeting(Meeting((char*)"Anime Convention 2", (char*)"Going to anime convention", MyDate(23, 10, 2022), MyHour(12, 0), MyHour(15, 0)));
+            journal.commit();
+            journal.checkpoint();
+            journal.removeMeeting(Meeting((char*)"Anime Convention 1", (char*)"Going to anime convention", MyDate(22, 10, 2022), MyHour(9, 0), MyHour(15, 0)));
+            journal.updateAllWithName((char*)"Anime Convention 2", Meeting((char*)"Anime Convention 3", (char*)"Moved", MyDate(24, 10, 2022), MyHour(10, 0), MyHour(12, 0)));
+            journal.commit();
+        }
+
+        // Simulating a crash in the middle of writing a record
+        {
+            ofstream broken("Journal.1.journal", ios::out | ios::binary | ios::app);
+            broken.write("\x30\x00\x00\x00\x12\x34", 6);
+        }
+
+        CalendarJournal recovered("Journal");
+        cout << "Recovered journal generation: " << recovered.getGeneration() << endl;
+        recovered.read([](const PersonalCalendar& calendar){
+            calendar.print();
+        });
+    }
+};
@@ -0,0 +1,439 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/*! This is a PersonalCalendar that can be used from many threads at the same time. Lookups, free hour
+ *  searches and the other reading functions take a shared lock, so any number of them run in parallel.
+ *  Changes take an exclusive lock and wait for the readers that already started.
+ *  One lock for the whole calendar is enough, because every change touches the indexes of all meetings
+ *  (the date index, the name index, the word indexes and the sums of the workload). Locks per date would still
+ *  need a lock around them. The meetings share the StringArena, which is safe to use from many threads by itself.
+ *
+ *  Long reads, like statistics over many months, should not hold the lock at all. snapshot() gives them the
+ *  current version of the calendar, which never changes after that (multiversion concurrency control).
+ *  The versions are copy-on-write: a change copies the calendar only if the version it would change is still
+ *  held by a snapshot, and then changes the copy. The old version is freed when its last snapshot is let go,
+ *  so the writers never wait for the readers of a snapshot. The copy is made before the exclusive lock is taken,
+ *  so the readers are stopped only for the change itself and not for copying every meeting and index.
+ *  NOTE: The versions share nothing. The first change after a snapshot is taken copies the whole calendar:
+ *  every meeting, the date, name, word and trigram indexes and the workload sums. That change costs O(n) in the
+ *  number of meetings instead of O(log n), and the other writers wait for it, because writers go one at a time
+ *  (see snapshotCopyCostTest()). The changes after it are cheap again until the next snapshot, so snapshots fit
+ *  long reads that are taken much less often than the calendar is changed.
+ *  NOTE: Every function returns copies of the meetings, because a pointer into the calendar would be
+ *  invalid as soon as the lock is let go. Use read() to look at many meetings under one lock */
+class ConcurrentCalendar{
+    //! PERSONALCALENDAR: The current version of the calendar. Snapshots share it until the next change
+    std::shared_ptr<PersonalCalendar> calendar;
+    /*! ATOMIC: The number of snapshots of the current version that are held. Every version has its own counter.
+     *  A snapshot lowers it with a release when it is let go, so a writer that sees 0 sees all reads of the snapshots */
+    std::shared_ptr<std::atomic<int>> snapshots;
+    //! UNSIGNED LONG LONG: The version number. It grows with every call that can change the calendar
+    unsigned long long version;
+    //! SHARED_MUTEX: Shared by the readers and taken alone by the writers
+    mutable std::shared_mutex lock;
+    //! MUTEX: Lets one writer at a time in, so the current version cannot change while a writer copies it
+    std::mutex writers;
+
+    /*! Calls change(calendar) on the current version under the exclusive lock, counts the change and returns
+     *  what change returns. If a snapshot holds the version, the change goes to a copy, which becomes the current version.
+     *  The copy is made under the shared lock, so the readers go on while it is made */
+    template <typename Change>
+    auto apply(Change change){
+        std::lock_guard<std::mutex> writing(writers);
+        std::shared_ptr<PersonalCalendar> copy;
+        while (true) {
+            {
+                // Snapshots are taken under the shared lock, so none can start while this one is held
+                std::unique_lock<std::shared_mutex> guard(lock);
+                if(copy != nullptr || snapshots->load(std::memory_order_acquire) == 0){
+                    if(copy != nullptr){
+                        calendar = std::move(copy);
+                        snapshots = std::make_shared<std::atomic<int>>(0);
+                    }
+                    version++;
+                    return change(*calendar);
+                }
+            }
+            // Only the writers change the current version and this one is the only writer,
+            // so the copy is still equal to it when the exclusive lock is taken again
+            std::shared_lock<std::shared_mutex> guard(lock);
+            copy = std::make_shared<PersonalCalendar>(*calendar);
+        }
+    }
+
+public:
+    // SECTION: CONSTRUCTORS------------------------------------------------------------------
+
+    //! Creates an empty calendar
+    ConcurrentCalendar() : calendar(std::make_shared<PersonalCalendar>()), snapshots(std::make_shared<std::atomic<int>>(0)), version(0){
+    }
+
+    //! Creates a calendar with the meetings of another one
+    explicit ConcurrentCalendar(const PersonalCalendar& other)
+            : calendar(std::make_shared<PersonalCalendar>(other)), snapshots(std::make_shared<std::atomic<int>>(0)), version(0){
+    }
+
+    //! The lock cannot be copied, so the calendar cannot be copied either
+    ConcurrentCalendar(const ConcurrentCalendar &other) = delete;
+    ConcurrentCalendar& operator = (const ConcurrentCalendar& rhs) = delete;
+
+    // SECTION: GETTERS AND SETTERS-----------------------------------------------------------
+
+    //! Calls action(calendar) while other threads can read but not change the calendar
+    template <typename Action>
+    void read(Action action) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        action((const PersonalCalendar&)*calendar);
+    }
+
+    //! Calls action(calendar) while no other thread can use the calendar
+    template <typename Action>
+    void write(Action action){
+        apply([&](PersonalCalendar& calendar){
+            action(calendar);
+        });
+    }
+
+    /*! Returns the current version of the calendar. It stays the same while other threads change the calendar,
+     *  so a long read can use it without any lock. Taking a snapshot copies nothing. NOTE: Hold it only as long
+     *  as it is needed, because the first change after it has to copy the calendar and the copy lives as long as it */
+    std::shared_ptr<const PersonalCalendar> snapshot() const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        snapshots->fetch_add(1, std::memory_order_relaxed);
+        // The last copy of the snapshot lowers the counter of its version and then lets the version go
+        std::shared_ptr<PersonalCalendar> held = calendar;
+        std::shared_ptr<std::atomic<int>> counter = snapshots;
+        return std::shared_ptr<const PersonalCalendar>(calendar.get(), [held, counter](const PersonalCalendar*){
+            counter->fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    //! Returns the version number. Two snapshots with the same version have the same meetings
+    unsigned long long getVersion() const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return version;
+    }
+
+    //! Returns a copy of the whole calendar
+    PersonalCalendar getCopy() const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return *calendar;
+    }
+
+    //! Getter for the number of meetings
+    int getCurrent() const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return calendar->getCurrent();
+    }
+
+    //! Getter for meeting by name. NOTE: Throws invalid_argument exception
+    Meeting getByName(char* name) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return calendar->getByName(name);
+    }
+
+    //! Getter for the earliest meeting on a given date. NOTE: Throws invalid_argument exception
+    Meeting getByDate(const MyDate& date) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return calendar->getByDate(date);
+    }
+
+    //! Getter for meeting by id. NOTE: Throws invalid_argument exception
+    Meeting getById(long long id) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return calendar->getById(id);
+    }
+
+    //! Checks if there is a meeting with the given id
+    bool containsId(long long id) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return calendar->containsId(id);
+    }
+
+    //! Returns the meetings of a given date sorted by startHour and endHour
+    std::vector<Meeting> getAllByDate(const MyDate& date) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        std::vector<Meeting> meetings(calendar->countByDate(date));
+        calendar->getAllByDate(meetings.data(), date);
+        return meetings;
+    }
+
+    //! Returns the meetings between two dates (inclusive) in sorted order
+    std::vector<Meeting> getAllInPeriod(const MyDate& s_date, const MyDate& e_date) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        std::vector<Meeting> meetings(calendar->countInPeriod(s_date, e_date));
+        calendar->getAllInPeriod(meetings.data(), s_date, e_date);
+        return meetings;
+    }
+
+    //! Returns the meetings that have a given word in the name
+    std::vector<Meeting> getAllByTokenInName(char* word) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        std::vector<Meeting> meetings(calendar->getCurrent());
+        meetings.resize(calendar->getAllByTokenInName(meetings.data(), word));
+        return meetings;
+    }
+
+    //! Returns the earliest meeting in the calendar. NOTE: Throws invalid_argument exception
+    Meeting getEarliestMeeting() const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return calendar->getEarliestMeeting();
+    }
+
+    //! Finds a free hour in a given time period. NOTE: Returns a meeting named "No free hour" if there is none
+    Meeting findFreeHour(const MyDate& s_date, const MyDate& e_date, const MyHour& s_hour, const MyHour& e_hour, const MyHour& duration) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return calendar->findFreeHour(s_date, e_date, s_hour, e_hour, duration);
+    }
+
+    //! The same as findFreeHour() but many threads search the days. See PersonalCalendar::findFreeHourParallel()
+    Meeting findFreeHourParallel(const MyDate& s_date, const MyDate& e_date, const MyHour& s_hour, const MyHour& e_hour, const MyHour& duration,
+                                 unsigned threads = std::thread::hardware_concurrency()) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return calendar->findFreeHourParallel(s_date, e_date, s_hour, e_hour, duration, threads);
+    }
+
+    //! Returns the first count free intervals of a period. See PersonalCalendar::findFreeHours()
+    std::vector<Meeting> findFreeHours(int count, const MyDate& s_date, const MyDate& e_date, const MyHour& s_hour, const MyHour& e_hour, const MyHour& duration) const {
+        std::vector<Meeting> freeList(count);
+        std::shared_lock<std::shared_mutex> guard(lock);
+        freeList.resize(calendar->findFreeHours(freeList.data(), count, s_date, e_date, s_hour, e_hour, duration));
+        return freeList;
+    }
+
+    //! Checks if no meeting takes any time between s_hour and e_hour of a given date
+    bool isFree(const MyDate& date, const MyHour& s_hour, const MyHour& e_hour) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return calendar->isFree(date, s_hour, e_hour);
+    }
+
+    //! Puts the busy minutes of every day of the week between two dates (inclusive) into minutes
+    void getWorkload(const MyDate& s_date, const MyDate& e_date, long long minutes[7]) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        calendar->getWorkload(s_date, e_date, minutes);
+    }
+
+    // SECTION: HELPER FUNCTIONS---------------------------------------------------------------
+
+    //! Adds a meeting. NOTE: Returns the id of the meeting
+    long long addMeeting(const Meeting& meeting){
+        return apply([&](PersonalCalendar& calendar){
+            return calendar.addMeeting(meeting);
+        });
+    }
+
+    //! Books a new meeting. NOTE: Throws invalid_argument exception if strict is set and the meeting conflicts
+    void bookMeeting(char* name, char* description, const MyDate& date, const MyHour& start, const MyHour& end, bool strict = false){
+        apply([&](PersonalCalendar& calendar){
+            calendar.bookMeeting(name, description, date, start, end, strict);
+        });
+    }
+
+    //! Removes a meeting. NOTE: Returns false if there is no such meeting
+    bool removeMeeting(const Meeting& meeting){
+        return apply([&](PersonalCalendar& calendar){
+            return calendar.removeMeeting(meeting);
+        });
+    }
+
+    //! Removes the meeting with the given id. NOTE: Returns false if there is no such meeting
+    bool removeById(long long id){
+        return apply([&](PersonalCalendar& calendar){
+            return calendar.removeById(id);
+        });
+    }
+
+    //! Replaces the meeting with the given id. NOTE: Returns false if there is no such meeting
+    bool updateById(long long id, const Meeting& new_meeting){
+        return apply([&](PersonalCalendar& calendar){
+            return calendar.updateById(id, new_meeting);
+        });
+    }
+
+    //! Removes the first meeting with the given name. NOTE: Throws invalid_argument exception
+    void removeMeetingByName(char* name){
+        apply([&](PersonalCalendar& calendar){
+            calendar.removeMeetingByName(name);
+        });
+    }
+
+    //! Replaces all meetings with the given name
+    void updateAllWithName(char* name, const Meeting& new_meeting){
+        apply([&](PersonalCalendar& calendar){
+            calendar.updateAllWithName(name, new_meeting);
+        });
+    }
+
+    // SECTION: TESTS-------------------------------------------------------------------------
+
+    /*! Test for the snapshots:
+     *  - Takes a snapshot and keeps booking meetings while it is held
+     *  - The snapshot still has the old meetings and the old workload, the calendar has the new ones
+     *  - Changes without a snapshot change the current version in place */
+    static void snapshotTest(){
+        ConcurrentCalendar shared;
+        shared.bookMeeting((char*) "Anime Convention 1", (char*)"Going to anime convention", MyDate(22, 10, 2022), MyHour(9, 0), MyHour(15, 0));
+        shared.bookMeeting((char*) "Anime Convention 2", (char*)"Going to anime convention", MyDate(23, 10, 2022), MyHour(12, 0), MyHour(15, 0));
+
+        std::shared_ptr<const PersonalCalendar> snapshot = shared.snapshot();
+        unsigned long long snapshot_version = shared.getVersion();
+        shared.bookMeeting((char*) "Anime Convention 3", (char*)"Going to anime convention", MyDate(23, 10, 2022), MyHour(17, 0), MyHour(20, 0));
+        shared.removeMeetingByName((char*) "Anime Convention 1");
+
+        long long minutes[7];
+        snapshot->getWorkload(MyDate(22, 10, 2022), MyDate(23, 10, 2022), minutes);
+        cout << "Snapshot version " << snapshot_version << ": " << snapshot->getCurrent() << " meetings, Saturday minutes: " << minutes[6] << endl;
+        shared.getWorkload(MyDate(22, 10, 2022), MyDate(23, 10, 2022), minutes);
+        cout << "Current version " << shared.getVersion() << ": " << shared.getCurrent() << " meetings, Saturday minutes: " << minutes[6] << endl;
+
+        snapshot.reset();
+        const PersonalCalendar* current_version = shared.snapshot().get();
+        shared.removeMeetingByName((char*) "Anime Convention 2");
+        cout << "Changed in place after the snapshots were let go: " << (shared.snapshot().get() == current_version ? "true" : "false") << endl;
+    }
+
+    /*! Benchmark for the changes made while a snapshot is held:
+     *  - Fills the calendar with meetings over a year
+     *  - Times changes while a snapshot is held, so every change copies the calendar, and changes without one
+     *  - A reader thread keeps reading during the changes and records its slowest read. The copy is made under
+     *    the shared lock, so the reads are slowed only by the change itself */
+    static void snapshotWriteLatencyTest(){
+        const int meetings_count = 20000;
+        const int rounds = 5;
+        ConcurrentCalendar shared;
+        shared.write([&](PersonalCalendar& calendar){
+            calendar.reserve(meetings_count);
+            for (int i = 0; i < meetings_count; ++i) {
+                std::string name = "Meeting " + std::to_string(i % 500);
+                calendar.addMeeting(Meeting(&name[0], (char*)"Latency test", MyDate(1, 1, 2022) + i % 365,
+                                            MyHour(8 + i % 9, 0), MyHour(9 + i % 9, 30)));
+            }
+        });
+
+        Meeting extra((char*)"Extra", (char*)"Added by the writer", MyDate(1, 6, 2022), MyHour(12, 0), MyHour(13, 0));
+        for (int held = 1; held >= 0; --held) {
+            double slowest_write = 0, slowest_read = 0;
+            for (int round = 0; round < rounds; ++round) {
+                std::shared_ptr<const PersonalCalendar> snapshot;
+                if(held) snapshot = shared.snapshot();
+
+                std::atomic<bool> done(false);
+                std::thread reader([&](){
+                    while (!done.load()) {
+                        auto start = std::chrono::steady_clock::now();
+                        shared.getAllByDate(MyDate(1, 6, 2022));
+                        slowest_read = std::max(slowest_read, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                    }
+                });
+                auto start = std::chrono::steady_clock::now();
+                shared.removeById(shared.addMeeting(extra));
+                slowest_write = std::max(slowest_write, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                done = true;
+                reader.join();
+            }
+            cout << (held ? "With a snapshot held" : "Without a snapshot") << ", slowest change in ms: " << slowest_write
+                 << ", slowest read in ms: " << slowest_read << endl;
+        }
+        cout << "Meetings after the test: " << shared.getCurrent() << endl;
+    }
+
+    /*! Benchmark for the cost of the first change after a snapshot:
+     *  - Grows the calendar to 5000, 10000, 20000 and 40000 meetings
+     *  - At every size times the change right after a snapshot is taken, which copies the calendar, and the next one
+     *  - Prints the time per 1000 meetings. It stays about the same, because the copy costs O(n) */
+    static void snapshotCopyCostTest(){
+        const int rounds = 3;
+        ConcurrentCalendar shared;
+        Meeting extra((char*)"Extra", (char*)"Added by the writer", MyDate(1, 6, 2022), MyHour(12, 0), MyHour(13, 0));
+        int meetings_count = 0;
+        for (int size = 5000; size <= 40000; size *= 2) {
+            shared.write([&](PersonalCalendar& calendar){
+                calendar.reserve(size);
+                for (; meetings_count < size; ++meetings_count) {
+                    std::string name = "Meeting " + std::to_string(meetings_count % 500);
+                    calendar.addMeeting(Meeting(&name[0], (char*)"Copy cost test", MyDate(1, 1, 2022) + meetings_count % 365,
+                                                MyHour(8 + meetings_count % 9, 0), MyHour(9 + meetings_count % 9, 30)));
+                }
+            });
+
+            double copying = 0, after = 0;
+            for (int round = 0; round < rounds; ++round) {
+                std::shared_ptr<const PersonalCalendar> snapshot = shared.snapshot();
+                auto start = std::chrono::steady_clock::now();
+                long long id = shared.addMeeting(extra);
+                auto middle = std::chrono::steady_clock::now();
+                shared.removeById(id);
+                copying += std::chrono::duration<double, std::milli>(middle - start).count();
+                after += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - middle).count();
+            }
+            cout << "Meetings: " << size << ", first change after a snapshot in ms: " << copying / rounds
+                 << " (" << copying / rounds * 1000 / size << " per 1000 meetings), next change in ms: " << after / rounds << endl;
+        }
+    }
+
+    /*! Stress test and benchmark for the readers:
+     *  - Fills the calendar with meetings over a year
+     *  - For 1, 2, 4... threads up to the number of cores, every thread runs the same number of lookups and free hour
+     *    searches while one more thread keeps adding and removing meetings
+     *  - Prints the reads per second for every number of threads. With the shared lock they grow with the cores */
+    static void readThroughputTest(){
+        const int meetings_count = 20000;
+        const int reads_per_thread = 2000;
+        ConcurrentCalendar shared;
+        shared.write([&](PersonalCalendar& calendar){
+            calendar.reserve(meetings_count);
+            for (int i = 0; i < meetings_count; ++i) {
+                std::string name = "Meeting " + std::to_string(i % 500);
+                calendar.addMeeting(Meeting(&name[0], (char*)"Stress test", MyDate(1, 1, 2022) + i % 365,
+                                            MyHour(8 + i % 9, 0), MyHour(9 + i % 9, 30)));
+            }
+        });
+
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned threads = 1; threads <= cores; threads *= 2) {
+            std::atomic<bool> done(false);
+            std::thread writer([&](){
+                Meeting extra((char*)"Extra", (char*)"Added by the writer", MyDate(1, 6, 2022), MyHour(12, 0), MyHour(13, 0));
+                while (!done.load()) {
+                    long long id = shared.addMeeting(extra);
+                    shared.removeById(id);
+                    std::this_thread::yield();
+                }
+            });
+
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> readers;
+            for (unsigned t = 0; t < threads; ++t) {
+                readers.emplace_back([&, t](){
+                    long long found = 0;
+                    for (int i = 0; i < reads_per_thread; ++i) {
+                        MyDate date = MyDate(1, 1, 2022) + (int)((i * 7 + t * 31) % 365);
+                        std::string name = "Meeting " + std::to_string(i % 500);
+                        found += shared.getByName(&name[0]).getDate().getSerial() > 0;
+                        found += (long long)shared.getAllByDate(date).size();
+                        found += (long long)shared.findFreeHours(3, date, date + 6, MyHour(8, 0), MyHour(18, 0), MyHour(0, 30)).size();
+                    }
+                    if(found == 0) cout << "No meetings were found" << endl;
+                });
+            }
+            for (std::thread& reader : readers) {
+                reader.join();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            done = true;
+            writer.join();
+
+            cout << "Threads: " << threads << ", reads per second: " << (long long)(threads * reads_per_thread * 3 / seconds) << endl;
+        }
+        cout << "Meetings after the test: " << shared.getCurrent() << endl;
+    }
+};
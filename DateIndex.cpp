@@ -0,0 +1,237 @@
+#include <iostream>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <set>
+#include <vector>
+
+using namespace std;
+
+/*! This is the index of the meetings ordered by date, startHour and endHour. It keeps (sort key, id) pairs,
+ *  where the sort key packs the date and both hours into one number (see Meeting::getSortKey()).
+ *  It has two layouts:
+ *  - tree: a balanced tree of pairs. Adding and removing costs log(n), but every step of a scan jumps to
+ *    another node somewhere on the heap
+ *  - columnar: two sorted arrays, one with the sort keys and one with the ids. Scans read the keys one after
+ *    another and look at an id only when they need the meeting. Adding and removing move the tail of the arrays,
+ *    except at the end, where it is a push_back
+ *  Both layouts give the same results and the same iterators, so the code that uses the index does not change */
+class DateIndex{
+public:
+    //! A pair of a sort key and a meeting id
+    typedef std::pair<long long, int> Entry;
+
+private:
+    //! SET: The pairs in the tree layout. Empty in the columnar layout
+    std::set<Entry> tree;
+    //! VECTOR: The sorted sort keys in the columnar layout. Empty in the tree layout
+    std::vector<long long> keys;
+    //! VECTOR: The id that goes with every key in the columnar layout
+    std::vector<int> ids;
+    //! BOOL: Whether the columnar layout is used
+    bool columnar;
+
+    //! Returns the position of the first pair that is not less than entry (or greater than it if upper is set)
+    size_t position(const Entry& entry, bool upper) const {
+        size_t low = std::lower_bound(keys.begin(), keys.end(), entry.first) - keys.begin();
+        while (low < keys.size() && keys[low] == entry.first && (ids[low] < entry.second || (upper && ids[low] == entry.second))) {
+            low++;
+        }
+        return low;
+    }
+
+public:
+    /*! An iterator over the pairs in order. It gives the pairs by value, because the columnar layout
+     *  has no pair in memory. it->first and it->second work as for the iterators of a set */
+    class const_iterator{
+        //! DATEINDEX: The index that is iterated
+        const DateIndex* owner;
+        //! ITERATOR: The position in the tree layout
+        std::set<Entry>::const_iterator node;
+        //! SIZE_T: The position in the columnar layout
+        size_t index;
+
+        //! Holds a pair for operator->
+        struct Arrow{
+            Entry entry;
+            const Entry* operator->() const {
+                return &entry;
+            }
+        };
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Entry value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Arrow pointer;
+        typedef Entry reference;
+
+        //! Creates an iterator at a position of the tree layout
+        const_iterator(const DateIndex* owner, std::set<Entry>::const_iterator node) : owner(owner), node(node), index(0){
+        }
+
+        //! Creates an iterator at a position of the columnar layout
+        const_iterator(const DateIndex* owner, size_t index) : owner(owner), index(index){
+        }
+
+        Entry operator*() const {
+            return owner->columnar ? Entry(owner->keys[index], owner->ids[index]) : *node;
+        }
+
+        Arrow operator->() const {
+            return Arrow{**this};
+        }
+
+        const_iterator& operator++(){
+            if(owner->columnar) index++;
+            else ++node;
+            return *this;
+        }
+
+        const_iterator operator++(int){
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return owner->columnar ? index == other.index : node == other.node;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+        //! Returns the number of pairs from first to last. Costs nothing in the columnar layout
+        friend size_t distanceOf(const const_iterator& first, const const_iterator& last){
+            if(first.owner->isColumnar()) return last.index - first.index;
+            return (size_t)std::distance(first.node, last.node);
+        }
+    };
+
+    // SECTION: CONSTRUCTORS------------------------------------------------------------------
+
+    //! Creates an empty index in the tree layout
+    DateIndex() : columnar(false){
+    }
+
+    // SECTION: GETTERS AND SETTERS-----------------------------------------------------------
+
+    //! Checks if the columnar layout is used
+    bool isColumnar() const {
+        return columnar;
+    }
+
+    //! Moves all pairs to the columnar or to the tree layout
+    void setColumnar(bool enabled){
+        if(enabled == columnar) return;
+        if(enabled){
+            keys.reserve(tree.size());
+            ids.reserve(tree.size());
+            for (const Entry& entry : tree) {
+                keys.push_back(entry.first);
+                ids.push_back(entry.second);
+            }
+            std::set<Entry>().swap(tree);
+        } else {
+            // The pairs are sorted, so every one goes right before end()
+            for (size_t i = 0; i < keys.size(); ++i) {
+                tree.emplace_hint(tree.end(), keys[i], ids[i]);
+            }
+            std::vector<long long>().swap(keys);
+            std::vector<int>().swap(ids);
+        }
+        columnar = enabled;
+    }
+
+    //! Returns the number of pairs
+    size_t size() const {
+        return columnar ? keys.size() : tree.size();
+    }
+
+    // SECTION: HELPER FUNCTIONS---------------------------------------------------------------
+
+    const_iterator begin() const {
+        return columnar ? const_iterator(this, (size_t)0) : const_iterator(this, tree.begin());
+    }
+
+    const_iterator end() const {
+        return columnar ? const_iterator(this, keys.size()) : const_iterator(this, tree.end());
+    }
+
+    //! Returns the first pair that is not less than entry
+    const_iterator lower_bound(const Entry& entry) const {
+        return columnar ? const_iterator(this, position(entry, false)) : const_iterator(this, tree.lower_bound(entry));
+    }
+
+    //! Returns the first pair that is greater than entry
+    const_iterator upper_bound(const Entry& entry) const {
+        return columnar ? const_iterator(this, position(entry, true)) : const_iterator(this, tree.upper_bound(entry));
+    }
+
+    //! Adds a pair. Pairs that are already in the index are not added again
+    void insert(const Entry& entry){
+        if(!columnar){
+            tree.insert(entry);
+            return;
+        }
+        // Meetings loaded in order are added at the end, so they never move the arrays
+        size_t at = !keys.empty() && Entry(keys.back(), ids.back()) < entry ? keys.size() : position(entry, false);
+        if(at < keys.size() && keys[at] == entry.first && ids[at] == entry.second) return;
+        keys.insert(keys.begin() + (std::ptrdiff_t)at, entry.first);
+        ids.insert(ids.begin() + (std::ptrdiff_t)at, entry.second);
+    }
+
+    //! Removes a pair if it is in the index
+    void erase(const Entry& entry){
+        if(!columnar){
+            tree.erase(entry);
+            return;
+        }
+        size_t at = position(entry, false);
+        if(at == keys.size() || keys[at] != entry.first || ids[at] != entry.second) return;
+        keys.erase(keys.begin() + (std::ptrdiff_t)at);
+        ids.erase(ids.begin() + (std::ptrdiff_t)at);
+    }
+
+    //! Removes all pairs. The layout stays the same
+    void clear(){
+        tree.clear();
+        keys.clear();
+        ids.clear();
+    }
+
+    //! Swaps the contents and the layouts of two indexes
+    void swap(DateIndex& other) noexcept {
+        tree.swap(other.tree);
+        keys.swap(other.keys);
+        ids.swap(other.ids);
+        std::swap(columnar, other.columnar);
+    }
+
+    // SECTION: TESTS-------------------------------------------------------------------------
+
+    /*! Test for the two layouts:
+     *  - Adds pairs out of order to an index in the columnar layout and removes one
+     *  - Searches the same range in both layouts */
+    static void layoutsTest(){
+        DateIndex index;
+        index.setColumnar(true);
+        index.insert({30, 1});
+        index.insert({10, 2});
+        index.insert({20, 3});
+        index.insert({20, 0});
+        index.insert({40, 4});
+        index.erase({40, 4});
+
+        cout << "Columnar pairs:";
+        for (const Entry& entry : index) {
+            cout << " (" << entry.first << ", " << entry.second << ")";
+        }
+        cout << endl;
+        cout << "Pairs from 15 to 30 in the columnar layout: " << distanceOf(index.lower_bound({15, 0}), index.upper_bound({30, 1})) << endl;
+        index.setColumnar(false);
+        cout << "Pairs from 15 to 30 in the tree layout: " << distanceOf(index.lower_bound({15, 0}), index.upper_bound({30, 1}))
+             << ", first id: " << index.lower_bound({15, 0})->second << endl;
+    }
+};
@@ -0,0 +1,34 @@
+#ifndef DIGITS_CPP
+#define DIGITS_CPP
+
+#include <string.h>
+
+/*! A helper for turning small numbers into text without sprintf and without allocations.
+ *  It is used by MyDate and MyHour to format themselves into a caller-provided buffer */
+struct Digits{
+    //! CHAR: All numbers from 00 to 99 written as pairs of chars
+    static constexpr char PAIRS[201] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+
+    //! Writes a number in the 0-99 range as two digits and returns the position after them
+    static char* writeTwo(char* buffer, int value){
+        memcpy(buffer, &PAIRS[value * 2], 2);
+        return buffer + 2;
+    }
+
+    //! Writes a number in the 0-9999 range as four digits and returns the position after them
+    static char* writeFour(char* buffer, int value){
+        return writeTwo(writeTwo(buffer, value / 100), value % 100);
+    }
+};
+
+#endif
@@ -1,14 +1,15 @@
 #include <iostream>
 #include "MyDate.cpp"
 #include "MyHour.cpp"
+#include "StringArena.cpp"
 
 using namespace std;
 
 class Meeting{
-    //! TEXT: A char array used for containing the name of the meeting
-    char* name;
-    //! TEXT: A char array used for describing the meeting
-    char* description;
+    //! TEXT: A handle to the name of the meeting in the shared StringArena
+    int name;
+    //! TEXT: A handle to the description of the meeting in the shared StringArena
+    int description;
     //! DATE: A MyDate object used for keeping the date of the meeting
     MyDate date;
     //! TIME: A MyHour object containing the starting hour
@@ -16,56 +17,49 @@ class Meeting{
     //! TIME: A MyHour object containing the ending hour
     MyHour endHour;
 
+    //! Returns the handle of the "Empty" name used by the default constructor
+    static int emptyName(){
+        // The first call keeps one reference forever, so the handle is never released
+        static const int handle = StringArena::shared().intern("Empty");
+        return handle;
+    }
+
 public:
     // SECTION: CONSTRUCTORS--------------------------------------------------------
     //! Constructor for Meeting class with name, description, date, startHour and endHour as input
-    Meeting(char* name, char* description, const MyDate& date, const MyHour& startHour, const MyHour& endHour){
-        this->name = new char[strlen(name)];
-        this->description = new char[strlen(description)];
-        setName(name);
-        setDescription(description);
-        setDate(date);
-        setStartHour(startHour);
-        setEndHour(endHour);
+    Meeting(char* name, char* description, const MyDate& date, const MyHour& startHour, const MyHour& endHour)
+            : date(date), startHour(startHour), endHour(endHour){
+        this->name = StringArena::shared().intern(name);
+        this->description = StringArena::shared().intern(description);
     }
 
-    //! Default constructor creates empty meeting object
-    Meeting(){
-
-        // Creating sample name and description to give to the set function
-        char* new_name = new char[20];
-        char* new_description = new char[100];
-
-        strcpy(new_name, "Empty");
-        strcpy(new_description, "");
-
-        this->name = new char[strlen(new_name)];
-        this->description = new char[strlen(new_description)];
-
-        // Setting the sample meeting parameters
-        setMeeting(new_name,
-                   new_description,
-                  MyDate(),
-                  MyHour(),
-                  MyHour());
-
-        // Deleting the sample name and description
-        delete[] new_name;
-        delete[] new_description;
+    //! Default constructor creates empty meeting object with name "Empty" and empty description
+    Meeting() : name(emptyName()), description(0){
+        StringArena::shared().retain(name);
+        StringArena::shared().retain(description);
     }
 
-    //! Copy constructor for the Meeting class
-    Meeting(const Meeting &other){
-        this->name = new char[strlen(other.getName())];
-        this->description = new char[strlen(other.getDescription())];
-        setMeeting(other.getName(), other.getDescription(), other.getDate(), other.getStartHour(), other.getEndHour());
+    //! Copy constructor for the Meeting class. Only the string handles are copied
+    Meeting(const Meeting &other)
+            : name(other.name), description(other.description),
+              date(other.date), startHour(other.startHour), endHour(other.endHour){
+        StringArena::shared().retain(name);
+        StringArena::shared().retain(description);
     }
 
 
+    //! Move constructor for the Meeting class. Takes the string handles and leaves the other meeting with empty strings
+    Meeting(Meeting &&other) noexcept
+            : name(other.name), description(other.description),
+              date(other.date), startHour(other.startHour), endHour(other.endHour){
+        other.name = 0;
+        other.description = 0;
+    }
+
     //! Destructor for the Meeting class
     ~Meeting() {
-        delete [] name;
-        delete [] description;
+        StringArena::shared().release(name);
+        StringArena::shared().release(description);
     }
 
     // SECTION: HELPER FUNCTIONS------------------------------------------
@@ -73,16 +67,16 @@ public:
     /*! A function to save the class into a binary file*/
     void save(ofstream& file){
         // Getting the size of the name string
-        size_t nameSize = strlen(name);
+        size_t nameSize = StringArena::shared().length(name);
         // Saving the size before the name string so we can then use it to load that string
         file.write(reinterpret_cast<char *>(&nameSize), sizeof(nameSize));
         // Saving the name
-        file.write(reinterpret_cast<char *>(name), nameSize);
+        file.write(getName(), nameSize);
 
         // Saving the description size and the description
-        size_t descSize = strlen(description);
+        size_t descSize = StringArena::shared().length(description);
         file.write(reinterpret_cast<char *>(&descSize), sizeof(descSize));
-        file.write(reinterpret_cast<char *>(description), descSize);
+        file.write(getDescription(), descSize);
 
         // Saving the other info from the class
         date.save(file);
@@ -99,6 +93,7 @@ public:
         char* new_name = new char[nameSize+1];
         // Reading nameSize bytes from the file and saving them to the new string
         file.read(reinterpret_cast<char *>(new_name), nameSize);
+        new_name[nameSize] = '\0';
         // Setting new_name as the current's class name and deleting it afterwards
         setName(new_name);
         delete [] new_name;
@@ -109,6 +104,7 @@ public:
 
         char* new_desc = new char[descSize + 1];
         file.read(reinterpret_cast<char *>(new_desc), descSize);
+        new_desc[descSize] = '\0';
         setDescription(new_desc);
         delete [] new_desc;
 
@@ -120,13 +116,23 @@ public:
     }
 
     // SECTION: GETTERS AND SETTERS-------------------------------------------------
-    //! Getter for name field
+    //! Getter for name field. NOTE: The text is shared with other meetings and must not be changed
     char *getName() const {
-        return name;
+        return StringArena::shared().get(name);
     }
 
-    //! Getter for description field
+    //! Getter for description field. NOTE: The text is shared with other meetings and must not be changed
     char *getDescription() const {
+        return StringArena::shared().get(description);
+    }
+
+    //! Getter for the handle of the name in the shared StringArena
+    int getNameHandle() const {
+        return name;
+    }
+
+    //! Getter for the handle of the description in the shared StringArena
+    int getDescriptionHandle() const {
         return description;
     }
 
@@ -145,20 +151,32 @@ public:
         return endHour;
     }
 
-    //! Setter for the name with memory handling
+    /*! Returns a key that orders meetings the same way as the < operator does.
+     * The date is packed in the upper bits and the starting and ending hours
+     * are kept as minutes in the lower 22 bits */
+    long long getSortKey() const {
+        return getDateKey(date)
+               | (long long)startHour.getTotalMinutes() << 11
+               | endHour.getTotalMinutes();
+    }
+
+    //! Returns the part of the sort key that is taken by the given date
+    static long long getDateKey(const MyDate& date){
+        return (long long)date.getSerial() << 22;
+    }
+
+    //! Setter for the name. The text is interned in the shared StringArena
     void setName(char *new_name) {
-        delete [] name;
-        int size = strlen(new_name);
-        name = new char[size + 1];
-        strcpy(name, new_name);
+        int handle = StringArena::shared().intern(new_name);
+        StringArena::shared().release(name);
+        name = handle;
     }
 
-    //! Setter for the description with memory handling
+    //! Setter for the description. The text is interned in the shared StringArena
     void setDescription(char *new_description) {
-        delete [] description;
-        int size = strlen(new_description);
-        description = new char[size + 1];
-        strcpy(description, new_description);
+        int handle = StringArena::shared().intern(new_description);
+        StringArena::shared().release(description);
+        description = handle;
     }
 
     //! Setter for the date
@@ -187,9 +205,9 @@ public:
 
     /*! A print function for the Meeting class. Includes memory handling for the
      * strings of date, startHour and endHour*/
-    void print(){
-        cout << "Meeting \"" << name << "\": " << endl;
-        cout << "Description: " << description << endl;
+    void print() const {
+        cout << "Meeting \"" << getName() << "\": " << endl;
+        cout << "Description: " << getDescription() << endl;
         cout << "Date: ";
         date.print();
         cout << "Starting hour: ";
@@ -198,17 +216,51 @@ public:
         endHour.print();
     }
 
+    /*! Appends the same text that print() shows to the end of a string.
+     *  Dates and hours are formatted in place, so no temporary strings are allocated */
+    void appendTo(std::string& str) const {
+        str.append("Meeting \"").append(getName()).append("\": \n");
+        str.append("Description: ").append(getDescription()).append("\n");
+        str.append("Date: ");
+        date.appendTo(str);
+        str.append("\nStarting hour: ");
+        startHour.appendTo(str);
+        str.append("\nEnding hour: ");
+        endHour.appendTo(str);
+        str.append("\n");
+    }
+
     // SECTION: OPERATORS---------------------------------------------------
 
-    void operator = (const Meeting& rhs){
-        setMeeting(rhs.getName(), rhs.getDescription(), rhs.getDate(), rhs.getStartHour(), rhs.getEndHour());
+    //! Overloading of the = operator. Only the string handles are copied
+    Meeting& operator = (const Meeting& rhs){
+        StringArena::shared().retain(rhs.name);
+        StringArena::shared().retain(rhs.description);
+        StringArena::shared().release(name);
+        StringArena::shared().release(description);
+        name = rhs.name;
+        description = rhs.description;
+        date = rhs.date;
+        startHour = rhs.startHour;
+        endHour = rhs.endHour;
+        return *this;
+    }
+
+    //! Move assignment for the Meeting class. The handles are swapped, so the other meeting releases the old strings
+    Meeting& operator = (Meeting&& rhs) noexcept {
+        std::swap(name, rhs.name);
+        std::swap(description, rhs.description);
+        date = rhs.date;
+        startHour = rhs.startHour;
+        endHour = rhs.endHour;
+        return *this;
     }
 
     /*! Equality operator for the Meeting class.
-     * Compares two meetings by all arguments. */
+     * Compares two meetings by all arguments. Equal strings are interned once, so comparing the handles is enough */
     bool operator==(const Meeting &rhs) const {
-        return strcmp(name, rhs.getName()) == 0 &&
-               strcmp(description, rhs.getDescription()) == 0 &&
+        return name == rhs.name &&
+               description == rhs.description &&
                date == rhs.getDate() &&
                startHour == rhs.getStartHour() &&
                endHour == rhs.getEndHour();
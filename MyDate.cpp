@@ -1,78 +1,108 @@
 #include <iostream>
 #include <string.h>
 #include <fstream>
+#include <string>
+#include "Digits.cpp"
 
 using namespace std;
 
 /*! This is a custom class created to hold the information about the date */
 class MyDate{
-    //! INT: Used for displaying the day in DD format
-    int day;
-    //! INT: Used for displaying the month in MM format
-    int month;
-    //! INT: Used for displaying the year in YYYY format
-    int year;
+    /*! INT: The date kept as the number of days since 0001-01-01.
+     *  Comparing and moving dates is a single integer operation */
+    int serial;
 
     // SECTION: VALIDATORS----------------------------------------------------------------------------
 
+    //! Checks if a year is a leap year
+    static constexpr bool isLeapYear(int year){
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    }
+
     /*! Validates days to be appropriate to the given month and year.
      * For the purpose of this project we will assume that a valid year is in the 1 - 9999 range. */
-    bool validateDate(int new_days, int new_month, int new_year){
+    static constexpr bool validateDate(int new_days, int new_month, int new_year){
         // Check if day, month and year are valid number
         if(new_days < 1 || new_month < 1 || new_year < 1 || new_year > 9999) return false;
 
         switch (new_month) {
             // Months with 31 days
             case 1: case 3: case 5: case 7: case 8: case 10: case 12:
-                if(new_days > 31) return false;
-                break;
+                return new_days <= 31;
             // Months with 30 days
             case 4: case 6: case 9: case 11:
-                if(new_days > 30) return false;
-                break;
-            // February
+                return new_days <= 30;
+            // February has 29 days in a leap year and 28 otherwise
             case 2:
-                // Leap year - there are 29 days in February
-                if((new_year % 4 == 0 && new_year % 100 != 0) || new_year % 400 == 0){
-                    if(new_days > 29) return false;
-                }
-                // Not a leap year - 28 days in February
-                else{
-                    if(new_days > 28) return false;
-                }
-                break;
+                return new_days <= (isLeapYear(new_year) ? 29 : 28);
             // In all other cases the month is invalid
             default:
                 return false;
         }
-
-        // If every check has passed the date is correct
-        return true;
     }
 
 public:
+    //! INT: The serial number of the last valid date 9999-12-31
+    static constexpr int MAX_SERIAL = 3652058;
+
+    // SECTION: CONVERSIONS---------------------------------------------------------------------------
+
+    /*! Converts a date to the number of days since 0001-01-01.
+     *  The logic is the days_from_civil algorithm by Howard Hinnant
+     *  http://howardhinnant.github.io/date_algorithms.html shifted so that 0001-01-01 is day 0 */
+    static constexpr int serialFromCivil(int day, int month, int year){
+        // The year is counted from March, so the leap day is the last day of the year
+        year -= month <= 2;
+        const int era = (year >= 0 ? year : year - 399) / 400;
+        const int yearOfEra = year - era * 400;
+        const int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 306;
+    }
+
+    //! Converts the number of days since 0001-01-01 back to day, month and year. The inverse of serialFromCivil()
+    static constexpr void civilFromSerial(int serial, int& day, int& month, int& year){
+        const int z = serial + 306;
+        const int era = (z >= 0 ? z : z - 146096) / 146097;
+        const int dayOfEra = z - era * 146097;
+        const int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const int shiftedMonth = (5 * dayOfYear + 2) / 153;
+        day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+        month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+        year = yearOfEra + era * 400 + (month <= 2);
+    }
+
     // SECTION: CONSTRUCTORS------------------------------------------------------------------------
 
     //! Constructor for MyDate class with day, month and year as input
-    MyDate(int day, int month, int year){
-        setDate(day, month, year);
+    constexpr MyDate(int day, int month, int year)
+            : serial(validateDate(day, month, year) ? serialFromCivil(day, month, year)
+                                                    : throw std::invalid_argument( "The given date is invalid" )){
     }
 
     //! Default constructor for MyDate class
     //!  - Sets the date to 2001-01-01
-    MyDate(){
-        setDate(1, 1, 2001);
+    constexpr MyDate() : serial(serialFromCivil(1, 1, 2001)){
     }
 
     //! Copy constructor for MyDate class
-    MyDate(MyDate const &other){
-        setDate(other.getDay(), other.getMonth(), other.getYear());
+    constexpr MyDate(MyDate const &other) = default;
+
+    /*! Creates a date from the number of days since 0001-01-01. The number is not validated,
+     *  so it is meant for values that already came from a valid date */
+    static constexpr MyDate fromSerial(int serial){
+        MyDate date;
+        date.serial = serial;
+        return date;
     }
 
     // SECTION: HELPER FUNCTIONS------------------------------------------
 
     /*! A function to save the date into a file*/
     void save(ofstream& file){
+        int day = 0, month = 0, year = 0;
+        civilFromSerial(serial, day, month, year);
         file.write((char*)&day, sizeof(int));
         file.write((char*)&month, sizeof(int));
         file.write((char*)&year, sizeof(int));
@@ -81,59 +111,25 @@ public:
 
     /*! A function to load the date from file*/
     void load(ifstream& file){
+        int day = 0, month = 0, year = 0;
         file.read((char*)&day, sizeof(int));
         file.read((char*)&month, sizeof(int));
         file.read((char*)&year, sizeof(int));
+        serial = serialFromCivil(day, month, year);
     }
 
     /*! A function to add a day to current date. Includes validation*/
     void addDay(){
-        // Adds a day
-        day++;
-
-        // Checks if the month is over and if yes it increments the month
-        switch (month) {
-            // Months with 31 days
-            case 1: case 3: case 5: case 7: case 8: case 10: case 12:
-                if(day > 31){
-                    day-=31;
-                    month++;
-                }
-                break;
-                // Months with 30 days
-            case 4: case 6: case 9: case 11:
-                if(day > 30){
-                    day-=30;
-                    month++;
-                }
-                break;
-                // February
-            case 2:
-                // Leap year - there are 29 days in February
-                if((year % 4 == 0 && year % 100 != 0) || year % 400 == 0){
-                    if(day > 29){
-                        day-=29;
-                        month++;
-                    }
-                }
-                    // Not a leap year - 28 days in February
-                else{
-                    if(day > 28){
-                        day-=28;
-                        month++;
-                    }
-                }
-                break;
-        }
+        addDays(1);
+    }
 
-        // If the year is over it resets the months and increments the year
-        if(month>12){
-            month-=12;
-            year++;
-        }
+    /*! A function to move the date with a given number of days. Negative numbers move it back.
+     *  Includes validation */
+    void addDays(int days){
+        serial += days;
 
         // Checks the date for problems
-        if(!validateDate(day, month, year)){
+        if(serial < 0 || serial > MAX_SERIAL){
             cout << "Something went wrong. Date is: ";
             print();
         }
@@ -143,41 +139,58 @@ public:
 
     //! Getter for the day
     int getDay() const {
+        int day = 0, month = 0, year = 0;
+        civilFromSerial(serial, day, month, year);
         return day;
     }
 
     //! Getter for the month
     int getMonth() const {
+        int day = 0, month = 0, year = 0;
+        civilFromSerial(serial, day, month, year);
         return month;
     }
 
     //! Getter for the year
     int getYear() const {
+        int day = 0, month = 0, year = 0;
+        civilFromSerial(serial, day, month, year);
         return year;
     }
 
+    //! Getter for the number of days since 0001-01-01
+    constexpr int getSerial() const {
+        return serial;
+    }
+
     //! Setter for the day with validation
     void setDay(int new_day) {
+        int day = 0, month = 0, year = 0;
+        civilFromSerial(serial, day, month, year);
         if(!validateDate(new_day, month, year)){
             throw std::invalid_argument( "The day is invalid or not compatible with other arguments" );
         }
-        this->day = new_day;
+        serial = serialFromCivil(new_day, month, year);
     }
 
     //! Setter for the month with validation
     void setMonth(int new_month) {
+        int day = 0, month = 0, year = 0;
+        civilFromSerial(serial, day, month, year);
         if(!validateDate(day, new_month, year)){
             throw std::invalid_argument( "The month is invalid or not compatible with other arguments" );
         }
-        this->month = new_month;
+        serial = serialFromCivil(day, new_month, year);
     }
 
     //! Setter for the year with validation
     void setYear(int new_year) {
+        int day = 0, month = 0, year = 0;
+        civilFromSerial(serial, day, month, year);
         if(!validateDate(day, month, new_year)){
             throw std::invalid_argument( "The year is invalid or not compatible with other arguments" );
         }
-        this->year = new_year;
+        serial = serialFromCivil(day, month, new_year);
     }
 
     //! Setter for day, month and year with validation
@@ -185,61 +198,54 @@ public:
         if(!validateDate(new_day, new_month, new_year)){
             throw std::invalid_argument( "The given date is invalid" );
         }
-        this->day = new_day;
-        this->month = new_month;
-        this->year = new_year;
+        serial = serialFromCivil(new_day, new_month, new_year);
     }
 
     /*! This function returns the day of the week in a number form 0-Sunday, 1-Monday... etc.
-     *  The logic for the function is from this article
-     *  https://www.codespeedy.com/how-to-find-day-from-date-in-cpp/ */
-    int getDayOfWeek()
-    {
-        static int t[] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
-        year -= month < 3;
-        return (year + year/4 - year/100 + year/400 + t[month-1] + day) % 7;
+     *  0001-01-01 was a Monday, so the day of the week follows directly from the serial number */
+    constexpr int getDayOfWeek() const {
+        return (serial + 1) % 7;
     }
 
 
-    /*! A function for getting the date in YYYY-MM-DD format as char*
-      - NOTE: The string has to be freed after use
-    */
-    char * getDateAsString() const {
-        // Allocating new memory for the string
-        char* str = new char[11];
-
-        // Turning hours and minutes variables into strings
-        char day_string[3];
-        char month_string[3];
-        char year_string[5];
+    //! INT: The length of a date in YYYY-MM-DD format without the terminating zero
+    static constexpr int STRING_LENGTH = 10;
 
-        sprintf(day_string, "%d", day);
-        sprintf(month_string, "%d", month);
-        sprintf(year_string, "%d", year);
+    /*! Writes the date in YYYY-MM-DD format into a buffer of at least STRING_LENGTH + 1 chars.
+     *  Nothing is allocated. Returns a pointer to the terminating zero, so more text can follow */
+    char * formatTo(char* buffer) const {
+        int day = 0, month = 0, year = 0;
+        civilFromSerial(serial, day, month, year);
 
-        // Formatting of the string
-        strcpy(str, year_string);
-        strcat(str, "-");
-
-        if(month < 10){
-            strcat(str, "0");
-        }
-        strcat(str, month_string);
-        strcat(str, "-");
+        buffer = Digits::writeFour(buffer, year);
+        *buffer++ = '-';
+        buffer = Digits::writeTwo(buffer, month);
+        *buffer++ = '-';
+        buffer = Digits::writeTwo(buffer, day);
+        *buffer = '\0';
+        return buffer;
+    }
 
-        if(day < 10){
-            strcat(str, "0");
-        }
-        strcat(str, day_string);
+    //! Appends the date in YYYY-MM-DD format to the end of a string
+    void appendTo(std::string& str) const {
+        char buffer[STRING_LENGTH + 1];
+        str.append(buffer, formatTo(buffer) - buffer);
+    }
 
+    /*! A function for getting the date in YYYY-MM-DD format as char*
+      - NOTE: The string has to be freed after use. Prefer formatTo() which does not allocate
+    */
+    char * getDateAsString() const {
+        char* str = new char[STRING_LENGTH + 1];
+        formatTo(str);
         return str;
     }
 
     /*! A function to print date into the console with YYYY-MM-DD formatting*/
     void print() const {
-        char* string_date = getDateAsString();
+        char string_date[STRING_LENGTH + 1];
+        formatTo(string_date);
         cout <<  string_date << endl;
-        delete [] string_date;
     }
 
     // SECTION: OPERATORS--------------------------------------------------
@@ -247,48 +253,51 @@ public:
 
 
     //! Overloading of the = operator
-    void operator = (const MyDate& rhs){
-        setDate(rhs.getDay(), rhs.getMonth(), rhs.getYear());
+    MyDate& operator = (const MyDate& rhs) = default;
+
+    //! Returns the date that is a given number of days after this one
+    constexpr MyDate operator + (int days) const {
+        return fromSerial(serial + days);
+    }
+
+    //! Returns the date that is a given number of days before this one
+    constexpr MyDate operator - (int days) const {
+        return fromSerial(serial - days);
+    }
+
+    //! Returns the number of days between two dates
+    constexpr int operator - (const MyDate &rhs) const {
+        return serial - rhs.serial;
     }
 
     //! Overloading of the == operator
-    bool operator==(const MyDate &rhs) const {
-        return day == rhs.getDay() &&
-               month == rhs.getMonth() &&
-               year == rhs.getYear();
+    constexpr bool operator==(const MyDate &rhs) const {
+        return serial == rhs.serial;
     }
 
     //! Overloading of the != operator
-    bool operator!=(const MyDate &rhs) const {
-        return !(rhs == *this);
+    constexpr bool operator!=(const MyDate &rhs) const {
+        return serial != rhs.serial;
     }
 
     //! Overloading of the < operator
-    bool operator<(const MyDate &rhs) const {
-        if (year < rhs.getYear())
-            return true;
-        if (rhs.getYear() < year)
-            return false;
-        if (month < rhs.getMonth())
-            return true;
-        if (rhs.month < getMonth())
-            return false;
-        return day < rhs.getDay();
+    constexpr bool operator<(const MyDate &rhs) const {
+        return serial < rhs.serial;
     }
 
     //! Overloading of the > operator
-    bool operator>(const MyDate &rhs) const {
-        return rhs < *this;
+    constexpr bool operator>(const MyDate &rhs) const {
+        return serial > rhs.serial;
     }
 
     //! Overloading of the <= operator
-    bool operator<=(const MyDate &rhs) const {
-        return !(rhs < *this);
+    constexpr bool operator<=(const MyDate &rhs) const {
+        return serial <= rhs.serial;
     }
 
     //! Overloading of the >= operator
-    bool operator>=(const MyDate &rhs) const {
-        return !(*this < rhs);
+    constexpr bool operator>=(const MyDate &rhs) const {
+        return serial >= rhs.serial;
     }
 
     // SECTION: TESTS-----------------------------------------
@@ -355,6 +364,31 @@ public:
         date2.print();
     }
 
+    /*! Test for the serial number arithmetic:
+     * - Moving a date across a leap day and across years with addDays()
+     * - Difference between two dates in days
+     * - Day of the week */
+    static void serialArithmeticTest(){
+        static_assert(MyDate::serialFromCivil(1, 1, 1) == 0, "0001-01-01 has to be day 0");
+        static_assert(MyDate(31, 12, 9999).getSerial() == MyDate::MAX_SERIAL, "9999-12-31 has to be the last day");
+
+        MyDate date = MyDate(28, 2, 2024);
+        date.addDays(1);
+        cout << "2024-02-28 + 1 day: ";
+        date.print();
+
+        date.addDays(366);
+        cout << "2024-02-29 + 366 days: ";
+        date.print();
+
+        date.addDays(-366);
+        cout << "Going back 366 days: ";
+        date.print();
+
+        cout << "Days between 2022-10-22 and 2024-02-29: " << (date - MyDate(22, 10, 2022)) << endl;
+        cout << "Day of the week of 2022-10-22 (6 is Saturday): " << MyDate(22, 10, 2022).getDayOfWeek() << endl;
+    }
+
     static void saveAndLoadTest(){
         cout << "Saving date1 to file and loading it to date2:" << endl;
         ofstream file("Date.dat", ios::out | ios::binary);
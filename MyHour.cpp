@@ -1,221 +1,221 @@
 #include <iostream>
+#include <cstdint>
 #include <string.h>
 #include <fstream>
+#include <string>
+#include "Digits.cpp"
 
 using namespace std;
 
 /*! This is a custom class created to hold the information about the hour */
 class MyHour{
-    //! INT: Used for displaying the hours in 24h format
-    int hours;
-    //! INT: Used for displaying the minutes in decimal format
-    int minutes;
+    //! UINT16: The hour kept as the number of minutes since 00:00
+    uint16_t minutesOfDay;
 
     // SECTION: VALIDATORS-----------------------------------------------------
 
     //! Validates minutes to be in the 0-59 range
-    bool validateMinutes(int new_minutes){
+    static constexpr bool validateMinutes(int new_minutes){
         return new_minutes>=0 && new_minutes<60;
     }
 
     //! Validates hours to be in the 0-23 range
-    bool validateHours(int new_hour){
+    static constexpr bool validateHours(int new_hour){
         return new_hour>=0 && new_hour<24;
     }
 
+    //! Returns the minutes of day for the given hours and minutes or throws if they are not valid
+    static constexpr uint16_t validated(int hours, int minutes){
+        return !validateHours(hours) ? throw std::invalid_argument( "Hour is not in 0-23 range" )
+             : !validateMinutes(minutes) ? throw std::invalid_argument( "Minutes are not in 0-59 range" )
+             : (uint16_t)(hours * 60 + minutes);
+    }
+
 
 public:
+    //! INT: The number of minutes in a day
+    static constexpr int MINUTES_IN_DAY = 24 * 60;
+
     // SECTION: CONSTRUCTORS---------------------------------------
 
     //! Constructor for MyHour class with hour and minutes as input
-    MyHour(int hours, int minutes){
-        setHours(hours);
-        setMinutes(minutes);
+    constexpr MyHour(int hours, int minutes) : minutesOfDay(validated(hours, minutes)){
     }
 
     //! Constructor for MyHour class only with hour as input
     //!  - Sets minutes to :00
-    MyHour(int hours){
-        setHours(hours);
-        setMinutes(0);
+    constexpr MyHour(int hours) : minutesOfDay(validated(hours, 0)){
     }
 
     //! Default constructor for MyHour class
     //!  - Sets the hour to 00:00
-    MyHour(){
-        setHours(0);
-        setMinutes(0);
+    constexpr MyHour() : minutesOfDay(0){
     }
 
     //! Copy constructor for MyHour class
-    MyHour(MyHour const &other){
-        setMinutes(other.getMinutes());
-        setHours(other.getHours());
+    constexpr MyHour(MyHour const &other) = default;
+
+    /*! Creates an hour from the number of minutes since 00:00 without validation.
+     *  It is the fast path for trusted sources like files written by save() and values
+     *  that are already known to be in the 0-1439 range */
+    static constexpr MyHour fromMinutes(int minutes){
+        MyHour hour;
+        hour.minutesOfDay = (uint16_t)minutes;
+        return hour;
     }
 
     // SECTION: HELPER FUNCTIONS------------------------------------------
     /*! Saves the hour into a file*/
     void save(ofstream& file){
+        int hours = getHours();
+        int minutes = getMinutes();
         file.write((char*)&hours, sizeof(int));
         file.write((char*)&minutes, sizeof(int));
 
     }
 
-    /*! Loads the hour from a file*/
+    /*! Loads the hour from a file. The value is validated like in the constructors, because an hour outside
+     *  the 0-1439 range would spill into the date bits of Meeting::getSortKey().
+     *  NOTE: Throws invalid_argument exception if the hours or the minutes are out of range */
     void load(ifstream& file){
+        int hours = 0, minutes = 0;
         file.read((char*)&hours, sizeof(int));
         file.read((char*)&minutes, sizeof(int));
+        minutesOfDay = validated(hours, minutes);
     }
 
 
     // SECTION: GETTERS AND SETTERS---------------------------------------
 
     //! Getter for hours field
-    int getHours() const {
-        return hours;
+    constexpr int getHours() const {
+        return minutesOfDay / 60;
     }
 
     //! Getter for minutes field
-    int getMinutes() const {
-        return minutes;
+    constexpr int getMinutes() const {
+        return minutesOfDay % 60;
+    }
+
+    //! Getter for the number of minutes since 00:00
+    constexpr int getTotalMinutes() const {
+        return minutesOfDay;
     }
 
     //! Setter for hours field
     //! - Also validates field to be in the 0-23 range
     void setHours(int new_hours) {
-        if(!validateHours(new_hours)){
-            throw std::invalid_argument( "Hour is not in 0-23 range" );
-        }
-        this->hours = new_hours;
+        minutesOfDay = validated(new_hours, getMinutes());
     }
 
 
     //! Setter for minutes field
     //! - Also validates field to be in the 0-59 range
     void setMinutes(int new_minutes) {
-        if(!validateMinutes(new_minutes)){
-            throw std::invalid_argument( "Minutes are not in 0-59 range" );
-        }
-        this->minutes = new_minutes;
+        minutesOfDay = validated(getHours(), new_minutes);
+    }
+
+    //! INT: The length of an hour in HH:MM format without the terminating zero
+    static constexpr int STRING_LENGTH = 5;
+
+    /*! Writes the hour in HH:MM format into a buffer of at least STRING_LENGTH + 1 chars.
+     *  Nothing is allocated. Returns a pointer to the terminating zero, so more text can follow */
+    char * formatTo(char* buffer) const {
+        buffer = Digits::writeTwo(buffer, getHours());
+        *buffer++ = ':';
+        buffer = Digits::writeTwo(buffer, getMinutes());
+        *buffer = '\0';
+        return buffer;
+    }
+
+    //! Appends the hour in HH:MM format to the end of a string
+    void appendTo(std::string& str) const {
+        char buffer[STRING_LENGTH + 1];
+        str.append(buffer, formatTo(buffer) - buffer);
     }
 
     /*! A function for getting the hour in HH:MM format as char*
-      - NOTE: The string has to be freed after use
+      - NOTE: The string has to be freed after use. Prefer formatTo() which does not allocate
     */
     char * getHourAsString() const {
-        // Allocating new memory for the string
-        char* str = new char[6];
-
-        // Turning hours and minutes variables into strings
-        char hours_string[3];
-        char minutes_string[3];
-
-        sprintf(hours_string, "%d", hours);
-        sprintf(minutes_string, "%d", minutes);
-
-        strcpy(str, "");
-        // Formatting of the string
-        if(hours<10){
-            strcat(str, "0");
-        }
-        strcat(str, hours_string);
-
-        strcat(str, ":");
-
-        if(minutes<10){
-            strcat(str, "0");
-        }
-        strcat(str, minutes_string);
-
+        char* str = new char[STRING_LENGTH + 1];
+        formatTo(str);
         return str;
     }
 
     /*! Prints the hour into a correct HH:MM format*/
     void print() const {
-        char* string_hour = getHourAsString();
+        char string_hour[STRING_LENGTH + 1];
+        formatTo(string_hour);
         cout <<  string_hour << endl;
-        delete [] string_hour;
     }
 
-    // SECTION: OPERATORS------------------------------------------------
+    // SECTION: ARITHMETIC----------------------------------------------
 
-    //! Overloading of the + operator
-    MyHour operator + (MyHour const &obj) const {
-        MyHour res;
-        res.hours = this->hours + obj.hours;
-        res.minutes = this->minutes + obj.minutes;
+    //! Adds two hours and wraps around midnight, so 23:00 + 02:00 is 01:00
+    constexpr MyHour addWrapping(MyHour const &obj) const {
+        return fromMinutes((minutesOfDay + obj.minutesOfDay) % MINUTES_IN_DAY);
+    }
 
-        if(res.minutes >= 60){
-            res.minutes -= 60;
-            res.hours++;
-        }
+    //! Adds two hours and stops at the end of the day, so 23:00 + 02:00 is 23:59
+    constexpr MyHour addSaturating(MyHour const &obj) const {
+        return fromMinutes(minutesOfDay + obj.minutesOfDay < MINUTES_IN_DAY ? minutesOfDay + obj.minutesOfDay
+                                                                            : MINUTES_IN_DAY - 1);
+    }
 
-        if(res.hours >= 24){
-            res.hours-=24;
-        }
-        return res;
+    //! Subtracts two hours and wraps around midnight, so 01:00 - 02:00 is 23:00
+    constexpr MyHour subtractWrapping(MyHour const &obj) const {
+        return fromMinutes((minutesOfDay + MINUTES_IN_DAY - obj.minutesOfDay) % MINUTES_IN_DAY);
     }
 
-    //! Overloading of the - operator
-    MyHour operator - (MyHour const &obj) const {
-        if(obj >= *this){
-            return {};
-        }
+    //! Subtracts two hours and stops at the start of the day, so 01:00 - 02:00 is 00:00
+    constexpr MyHour subtractSaturating(MyHour const &obj) const {
+        return fromMinutes(minutesOfDay > obj.minutesOfDay ? minutesOfDay - obj.minutesOfDay : 0);
+    }
 
-        MyHour res;
-        res.hours = this->hours - obj.hours;
-        res.minutes = this->minutes - obj.minutes;
+    // SECTION: OPERATORS------------------------------------------------
 
-        if(res.minutes < 0){
-            res.minutes += 60;
-            res.hours--;
-        }
+    //! Overloading of the + operator. Wraps around midnight like addWrapping()
+    constexpr MyHour operator + (MyHour const &obj) const {
+        return addWrapping(obj);
+    }
 
-        if(res.hours < 0){
-            return {};
-        }
-        return res;
+    //! Overloading of the - operator. Stops at 00:00 like subtractSaturating()
+    constexpr MyHour operator - (MyHour const &obj) const {
+        return subtractSaturating(obj);
     }
 
     //! Overloading of the = operator
-    void operator = (const MyHour& rhs){
-        this->hours = rhs.getHours();
-        this->minutes = rhs.getMinutes();
-    }
+    MyHour& operator = (const MyHour& rhs) = default;
 
     //! Overloading of the < operator
-    bool operator<(const MyHour &rhs) const {
-        if (hours < rhs.getHours())
-            return true;
-        if (rhs.getHours() < hours)
-            return false;
-        return minutes < rhs.getMinutes();
+    constexpr bool operator<(const MyHour &rhs) const {
+        return minutesOfDay < rhs.minutesOfDay;
     }
 
     //! Overloading of the > operator
-    bool operator>(const MyHour &rhs) const {
-        return rhs < *this;
+    constexpr bool operator>(const MyHour &rhs) const {
+        return minutesOfDay > rhs.minutesOfDay;
     }
 
     //! Overloading of the <= operator
-    bool operator<=(const MyHour &rhs) const {
-        return !(rhs < *this);
+    constexpr bool operator<=(const MyHour &rhs) const {
+        return minutesOfDay <= rhs.minutesOfDay;
     }
 
     //! Overloading of the >= operator
-    bool operator>=(const MyHour &rhs) const {
-        return !(*this < rhs);
+    constexpr bool operator>=(const MyHour &rhs) const {
+        return minutesOfDay >= rhs.minutesOfDay;
     }
 
     //! Overloading of the == operator
-    bool operator==(const MyHour &rhs) const {
-        return hours == rhs.getHours() &&
-               minutes == rhs.getMinutes();
+    constexpr bool operator==(const MyHour &rhs) const {
+        return minutesOfDay == rhs.minutesOfDay;
     }
 
     //! Overloading of the != operator
-    bool operator!=(const MyHour &rhs) const {
-        return !(rhs == *this);
+    constexpr bool operator!=(const MyHour &rhs) const {
+        return minutesOfDay != rhs.minutesOfDay;
     }
     // SECTION: TESTS----------------------------------
 
@@ -263,6 +263,21 @@ public:
         res2.print();
     }
     
+    /*! Test for the wrapping and saturating arithmetic around midnight*/
+    static void arithmeticModesTest(){
+        static_assert(MyHour(23, 0).addWrapping(MyHour(2, 0)) == MyHour(1, 0), "Adding has to wrap around midnight");
+        static_assert(MyHour(1, 0) - MyHour(2, 0) == MyHour(), "The - operator has to stop at 00:00");
+
+        cout << "23:00 + 02:00 wrapping = ";
+        MyHour(23, 0).addWrapping(MyHour(2, 0)).print();
+        cout << "23:00 + 02:00 saturating = ";
+        MyHour(23, 0).addSaturating(MyHour(2, 0)).print();
+        cout << "01:00 - 02:00 wrapping = ";
+        MyHour(1, 0).subtractWrapping(MyHour(2, 0)).print();
+        cout << "01:00 - 02:00 saturating = ";
+        MyHour(1, 0).subtractSaturating(MyHour(2, 0)).print();
+    }
+
     /*! Test for saving and loading the hour to file*/
     static void saveAndLoadTest(){
         cout << "Saving hour1 to file and loading it to hour2:" << endl;
@@ -282,6 +297,18 @@ public:
         hour2.load(in);
         in.close();
         hour2.print();
+
+        // A stored hour of 40:00 would not fit in the sort key of a meeting
+        ofstream broken("Hour.dat", ios::out | ios::binary);
+        int fields[2] = {40, 0};
+        broken.write((char*)fields, sizeof(fields));
+        broken.close();
+        ifstream broken_in("Hour.dat", ios::in | ios::binary);
+        try {
+            hour2.load(broken_in);
+        } catch (std::invalid_argument& e) {
+            cout << "Loading 40:00 failed: " << e.what() << endl;
+        }
     }
 
 
@@ -0,0 +1,143 @@
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+/*! This is a hash index from the exact name of a meeting to the ids of all meetings with that name.
+ *  Names are interned in the StringArena, so equal names have equal handles and the index is keyed by
+ *  the handle instead of the text. The table uses open addressing with linear probing */
+class NameIndex{
+    //! A single position in the table
+    struct Bucket{
+        //! INT: The handle of the name. EMPTY_KEY and REMOVED_KEY mark free positions
+        int key;
+        //! VECTOR: The ids of the meetings with this name in no particular order
+        std::vector<int> ids;
+    };
+
+    //! INT: Marks a position that was never used
+    static constexpr int EMPTY_KEY = -1;
+    //! INT: Marks a position that was used by a name that is no longer in the index
+    static constexpr int REMOVED_KEY = -2;
+
+    //! VECTOR: The table. Its size is always a power of two
+    std::vector<Bucket> buckets;
+    //! INT: The number of positions that are not EMPTY_KEY
+    int used;
+
+    //! Returns the first position to look at for a given key
+    size_t startOf(int key) const {
+        // Fibonacci hashing spreads the small consecutive handles over the whole table
+        return (size_t)((unsigned)key * 2654435769u) & (buckets.size() - 1);
+    }
+
+    //! Returns the position of a key or -1 if the key is not in the table
+    long find(int key) const {
+        if(buckets.empty()) return -1;
+        size_t mask = buckets.size() - 1;
+        for (size_t i = startOf(key); buckets[i].key != EMPTY_KEY; i = (i + 1) & mask) {
+            if(buckets[i].key == key) return (long)i;
+        }
+        return -1;
+    }
+
+    //! Makes the table big enough for one more key and clears the removed positions
+    void reserve(){
+        if(!buckets.empty() && (used + 1) * 10 < (int)buckets.size() * 7) return;
+
+        int live = 0;
+        for (const Bucket& bucket : buckets) {
+            if(bucket.key >= 0) live++;
+        }
+        size_t new_size = buckets.empty() ? 16 : buckets.size();
+        while ((size_t)(live + 1) * 2 >= new_size) new_size *= 2;
+
+        std::vector<Bucket> old_buckets;
+        old_buckets.swap(buckets);
+        buckets.assign(new_size, Bucket{EMPTY_KEY, {}});
+        used = 0;
+        for (Bucket& bucket : old_buckets) {
+            if(bucket.key >= 0) insertBucket(bucket.key).ids = std::move(bucket.ids);
+        }
+    }
+
+    //! Puts a new key in the table and returns its bucket. The table has to have a free position
+    Bucket& insertBucket(int key){
+        size_t mask = buckets.size() - 1;
+        size_t i = startOf(key);
+        while (buckets[i].key >= 0) {
+            i = (i + 1) & mask;
+        }
+        if(buckets[i].key == EMPTY_KEY) used++;
+        buckets[i].key = key;
+        return buckets[i];
+    }
+
+public:
+    // SECTION: CONSTRUCTORS------------------------------------------------------------------
+
+    //! Creates an empty index
+    NameIndex() : used(0){
+    }
+
+    // SECTION: HELPER FUNCTIONS---------------------------------------------------------------
+
+    //! Adds a meeting id under the given name handle
+    void add(int name, int id){
+        long position = find(name);
+        if(position >= 0){
+            buckets[position].ids.push_back(id);
+            return;
+        }
+        reserve();
+        insertBucket(name).ids.push_back(id);
+    }
+
+    //! Removes a meeting id from the given name handle
+    void remove(int name, int id){
+        long position = find(name);
+        if(position < 0) return;
+        std::vector<int>& ids = buckets[position].ids;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if(ids[i] == id){
+                ids[i] = ids.back();
+                ids.pop_back();
+                break;
+            }
+        }
+        if(ids.empty()){
+            buckets[position].key = REMOVED_KEY;
+            ids.shrink_to_fit();
+        }
+    }
+
+    //! Removes all names from the index
+    void clear(){
+        buckets.clear();
+        used = 0;
+    }
+
+    /*! Returns the ids of all meetings with the given name handle in no particular order.
+     *  NOTE: Returns nullptr if there are none. The list is valid until the index is changed */
+    const std::vector<int>* get(int name) const {
+        long position = find(name);
+        if(position < 0) return nullptr;
+        return &buckets[position].ids;
+    }
+
+    // SECTION: TESTS-------------------------------------------------------------------------
+
+    //! Test for adding and removing ids under a few names
+    static void addAndRemoveTest(){
+        NameIndex index;
+        for (int id = 0; id < 100; ++id) {
+            index.add(id % 7 + 1, id);
+        }
+        cout << "Meetings with name 3: " << index.get(3)->size() << endl;
+        for (int id = 2; id < 100; id += 7) {
+            index.remove(3, id);
+        }
+        cout << "After removing all of them: " << (index.get(3) == nullptr ? "none" : "some left") << endl;
+        cout << "Meetings with name 4: " << index.get(4)->size() << endl;
+    }
+};
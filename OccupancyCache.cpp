@@ -0,0 +1,172 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+/*! This is a cache of the busy minutes of every day that has meetings. Each day is a bitmap of 1440 bits,
+ *  one for every minute, where a set bit means that some meeting takes that minute. Free time is found by
+ *  looking at whole 64 bit words (and 256 bit blocks when AVX2 is available) instead of single minutes.
+ *  The cache is disabled by default, because it takes 192 bytes for every day with meetings */
+class OccupancyCache{
+    //! INT: The number of 64 bit words of a day. 1440 bits need 22.5 words, the rest is always zero
+    static constexpr int WORDS_IN_DAY = 24;
+
+    //! The bitmap of a single day
+    struct Day{
+        //! UINT64_T: The busy minutes. Minute m is bit m % 64 of word m / 64
+        uint64_t words[WORDS_IN_DAY];
+    };
+
+    //! MAP: The bitmaps of all days with meetings, found by the serial number of the date
+    std::unordered_map<int, Day> days;
+    //! BOOL: Whether the cache is used at all
+    bool enabled;
+
+    //! Returns the first word in [from, to) that is not equal to pattern or to if there is none
+    static int firstWordNotEqual(const uint64_t* words, int from, int to, uint64_t pattern){
+        int i = from;
+#ifdef __AVX2__
+        // Comparing four words at once. The movemask has one bit for every equal word
+        __m256i repeated = _mm256_set1_epi64x((long long)pattern);
+        for (; i + 4 <= to; i += 4) {
+            __m256i block = _mm256_loadu_si256((const __m256i*)(words + i));
+            int equal = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(block, repeated)));
+            if(equal != 0xF) return i + __builtin_ctz(~equal & 0xF);
+        }
+#endif
+        for (; i < to; ++i) {
+            if(words[i] != pattern) return i;
+        }
+        return to;
+    }
+
+    /*! Returns the first minute in [from, limit) that is busy (or free if busy is false) or limit if there is none.
+     *  Whole words that cannot contain such a minute are skipped without looking at their bits */
+    static int findNext(const uint64_t* words, int from, int limit, bool busy){
+        if(from >= limit) return limit;
+        // Flipping the bits when looking for a free minute, so the search is always for a set bit
+        uint64_t flip = busy ? 0 : ~0ULL;
+        int word = from >> 6;
+        int last = (limit - 1) >> 6;
+        uint64_t bits = (words[word] ^ flip) & (~0ULL << (from & 63));
+        while (bits == 0) {
+            word = firstWordNotEqual(words, word + 1, last + 1, flip);
+            if(word > last) return limit;
+            bits = words[word] ^ flip;
+        }
+        return std::min(word * 64 + __builtin_ctzll(bits), limit);
+    }
+
+public:
+    // SECTION: CONSTRUCTORS------------------------------------------------------------------
+
+    //! Creates an empty and disabled cache
+    OccupancyCache() : enabled(false){
+    }
+
+    // SECTION: GETTERS AND SETTERS-----------------------------------------------------------
+
+    //! Checks if the cache is used
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    //! Turns the cache on or off. It is always empty after the call and has to be filled with add()
+    void setEnabled(bool new_enabled){
+        enabled = new_enabled;
+        days.clear();
+    }
+
+    //! Returns the number of days that have a bitmap
+    int getDayCount() const {
+        return (int)days.size();
+    }
+
+    // SECTION: HELPER FUNCTIONS---------------------------------------------------------------
+
+    //! Marks the minutes in [start, end) of the given day as busy
+    void add(int day, int start, int end){
+        if(!enabled || start >= end) return;
+        auto found = days.find(day);
+        if(found == days.end()) found = days.emplace(day, Day{}).first;
+        uint64_t* words = found->second.words;
+
+        int first = start >> 6;
+        int last = (end - 1) >> 6;
+        uint64_t first_mask = ~0ULL << (start & 63);
+        uint64_t last_mask = ~0ULL >> (63 - ((end - 1) & 63));
+        if(first == last){
+            words[first] |= first_mask & last_mask;
+            return;
+        }
+        words[first] |= first_mask;
+        for (int i = first + 1; i < last; ++i) {
+            words[i] = ~0ULL;
+        }
+        words[last] |= last_mask;
+    }
+
+    //! Removes the bitmaps of all days. The cache stays enabled
+    void clear(){
+        days.clear();
+    }
+
+    /*! Removes the bitmap of a day. Meetings can overlap, so a single meeting cannot be taken out of the bits.
+     *  Instead the day is cleared and the remaining meetings are added again */
+    void clearDay(int day){
+        days.erase(day);
+    }
+
+    //! Checks if all minutes in [start, end) of the given day are free
+    bool isFree(int day, int start, int end) const {
+        auto found = days.find(day);
+        if(found == days.end()) return true;
+        return findNext(found->second.words, start, end, true) == end;
+    }
+
+    /*! Calls action(run_start, run_end) for every maximal run of free minutes inside [start, end) of the given day
+     *  that is at least length minutes long. Stops early when action returns false.
+     *  NOTE: Returns false if it was stopped */
+    template <typename Action>
+    bool forEachFreeRun(int day, int start, int end, int length, Action action) const {
+        auto found = days.find(day);
+        if(found == days.end()){
+            return end - start < length || action(start, end);
+        }
+        const uint64_t* words = found->second.words;
+        int run_start = findNext(words, start, end, false);
+        while (run_start < end) {
+            int run_end = findNext(words, run_start, end, true);
+            if(run_end - run_start >= length && !action(run_start, run_end)) return false;
+            run_start = findNext(words, run_end, end, false);
+        }
+        return true;
+    }
+
+    // SECTION: TESTS-------------------------------------------------------------------------
+
+    /*! Test for the bitmaps:
+     *  - Marks two overlapping intervals and one that crosses a word boundary as busy
+     *  - Prints the free runs of at least 30 minutes between 8:00 and 18:00 */
+    static void freeRunsTest(){
+        OccupancyCache cache;
+        cache.setEnabled(true);
+        cache.add(1, 9 * 60, 14 * 60);
+        cache.add(1, 10 * 60, 11 * 60);
+        cache.add(1, 16 * 60 - 5, 17 * 60 + 5);
+
+        cout << "Free runs of day 1 between 8:00 and 18:00:" << endl;
+        cache.forEachFreeRun(1, 8 * 60, 18 * 60, 30, [](int run_start, int run_end){
+            cout << run_start / 60 << ":" << run_start % 60 / 10 << run_start % 10 << " - "
+                 << run_end / 60 << ":" << run_end % 60 / 10 << run_end % 10 << endl;
+            return true;
+        });
+        cout << "Is 14:00 - 15:00 free: " << (cache.isFree(1, 14 * 60, 15 * 60) ? "true" : "false") << endl;
+        cout << "Is 13:00 - 15:00 free: " << (cache.isFree(1, 13 * 60, 15 * 60) ? "true" : "false") << endl;
+    }
+};
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <string>
+
+using namespace std;
+
+/*! This is the list of pages of a paged snapshot. A paged snapshot splits the calendar by date into pages of
+ *  PAGE_DAYS days and keeps every page in its own CalendarFile named base.page.P.V, where P is the number of
+ *  the page and V is the version of the snapshot that wrote it. A changed page is written as a new file and the
+ *  old one stays until the manifest that points to the new one is in place, so a crash in the middle of a save
+ *  leaves the previous snapshot whole (copy-on-write).
+ *  The manifest is a text file: "PPAGES <version>" followed by one "<page> <version>" line for every page */
+class PageManifest{
+    //! UNSIGNED LONG LONG: The version of the last save
+    unsigned long long version;
+    //! MAP: The version of the file of every page that has meetings
+    std::map<int, unsigned long long> pages;
+
+public:
+    //! INT: The number of days in a page. Pages start on the days whose serial number divides by it
+    static constexpr int PAGE_DAYS = 32;
+
+    // SECTION: CONSTRUCTORS------------------------------------------------------------------
+
+    //! Creates an empty manifest
+    PageManifest() : version(0){
+    }
+
+    // SECTION: GETTERS AND SETTERS-----------------------------------------------------------
+
+    //! Getter for the version of the last save
+    unsigned long long getVersion() const {
+        return version;
+    }
+
+    //! Setter for the version of the last save
+    void setVersion(unsigned long long new_version){
+        version = new_version;
+    }
+
+    //! Getter for all pages and their versions
+    const std::map<int, unsigned long long>& getPages() const {
+        return pages;
+    }
+
+    //! Sets the version of a page file. Pages without meetings have no file and are removed
+    void setPage(int page, unsigned long long page_version, bool empty){
+        if(empty) pages.erase(page);
+        else pages[page] = page_version;
+    }
+
+    //! Returns the version of a page file or 0 if the page has no file
+    unsigned long long getPage(int page) const {
+        auto found = pages.find(page);
+        return found == pages.end() ? 0 : found->second;
+    }
+
+    // SECTION: HELPER FUNCTIONS---------------------------------------------------------------
+
+    //! Returns the page of a date
+    static int pageOf(const MyDate& date){
+        return date.getSerial() / PAGE_DAYS;
+    }
+
+    //! Returns the first date of a page
+    static MyDate firstDateOf(int page){
+        return MyDate::fromSerial(page * PAGE_DAYS);
+    }
+
+    //! Returns the last date of a page
+    static MyDate lastDateOf(int page){
+        return MyDate::fromSerial(std::min(page * PAGE_DAYS + PAGE_DAYS - 1, MyDate::MAX_SERIAL));
+    }
+
+    //! Returns the path of a page file
+    static std::string pagePath(const std::string& base, int page, unsigned long long page_version){
+        return base + ".page." + std::to_string(page) + "." + std::to_string(page_version);
+    }
+
+    //! Returns the path of the manifest
+    static std::string manifestPath(const std::string& base){
+        return base + ".pages";
+    }
+
+    /*! Reads the manifest of a paged snapshot. NOTE: Returns false if there is no manifest.
+     *  Throws invalid_argument exception if the manifest is corrupted */
+    bool load(const std::string& base){
+        pages.clear();
+        version = 0;
+        ifstream file(manifestPath(base));
+        if(!file) return false;
+
+        std::string magic;
+        if(!(file >> magic >> version) || magic != "PPAGES") throw std::invalid_argument( "The page manifest is corrupted" );
+        int page = 0;
+        unsigned long long page_version = 0;
+        while (file >> page >> page_version) {
+            pages[page] = page_version;
+        }
+        if(!file.eof()) throw std::invalid_argument( "The page manifest is corrupted" );
+        return true;
+    }
+
+    //! Writes the manifest through a temporary file, so the old one is replaced in one step. NOTE: Throws invalid_argument exception
+    void save(const std::string& base) const {
+        std::string path = manifestPath(base);
+        {
+            ofstream file(path + ".tmp", ios::out | ios::trunc);
+            if(!file) throw std::invalid_argument( "Couldn't open file" );
+            file << "PPAGES " << version << "\n";
+            for (const std::pair<const int, unsigned long long>& page : pages) {
+                file << page.first << " " << page.second << "\n";
+            }
+            if(!file) throw std::invalid_argument( "Couldn't write file" );
+        }
+        CalendarFile::replaceFile(path + ".tmp", path);
+    }
+
+    // SECTION: TESTS-------------------------------------------------------------------------
+
+    /*! Test for the manifest:
+     *  - Saves a manifest with two pages and loads it again
+     *  - Prints the page of a date and its first and last date */
+    static void saveAndLoadTest(){
+        PageManifest manifest;
+        manifest.setVersion(3);
+        manifest.setPage(pageOf(MyDate(22, 10, 2022)), 3, false);
+        manifest.setPage(pageOf(MyDate(1, 1, 2023)), 1, false);
+        manifest.save("Manifest");
+
+        PageManifest loaded;
+        loaded.load("Manifest");
+        cout << "Manifest version: " << loaded.getVersion() << ", pages: " << loaded.getPages().size() << endl;
+        cout << "Version of the page of 2022-10-22: " << loaded.getPage(pageOf(MyDate(22, 10, 2022))) << endl;
+        cout << "The page of 2022-10-22 is from ";
+        firstDateOf(pageOf(MyDate(22, 10, 2022))).print();
+        cout << " to ";
+        lastDateOf(pageOf(MyDate(22, 10, 2022))).print();
+        cout << endl;
+    }
+};
@@ -1,5 +1,25 @@
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <functional>
+#include <new>
+#include <queue>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
 #include "Meeting.cpp"
+#include "PostingList.cpp"
+#include "WordIndex.cpp"
+#include "TrigramIndex.cpp"
+#include "NameIndex.cpp"
+#include "DateIndex.cpp"
+#include "OccupancyCache.cpp"
+#include "WorkloadIndex.cpp"
+#include "CalendarFile.cpp"
+#include "BufferedReader.cpp"
+#include "PageManifest.cpp"
 
 using namespace std;
 
@@ -16,68 +36,433 @@ using namespace std;
  */
 
 class PersonalCalendar{
-    //! MEETING: An array that contains all the meetings
+    //! INT: The number of chars print() collects before writing them to the console
+    static constexpr size_t PRINT_BUFFER_SIZE = 64 * 1024;
+    //! INT: The number of days findFreeHourParallel() gives to a thread at once
+    static constexpr int FREE_HOUR_BATCH_DAYS = 16;
+    /*! INT: Periods with fewer batches than this are searched by findFreeHour() in the calling thread,
+     *  because starting and joining the threads costs more than searching a few batches */
+    static constexpr int FREE_HOUR_PARALLEL_BATCHES = 8;
+
+    /*! MEETING: An array that contains all the meetings in no particular order.
+     *  Only the first `constructed` positions hold meetings, the rest is uninitialized memory */
     Meeting* meetingList;
     //! INT: The number of the current meeting. Used to keep the number of meetings in the calendar
     int current;
     //! INT: Contains the size of the array
     int size;
+    /*! INT: The number of constructed meetings at the start of meetingList. It is equal to current
+     *  unless getMeetingList() had to prepare the whole array to be written from outside */
+    int constructed;
+    //! VECTOR: The id of the meeting that is kept on every position of meetingList
+    std::vector<int> slotIds;
+    //! VECTOR: The position in meetingList of every meeting id. Removed ids point to -1
+    std::vector<int> idSlots;
+    /*! VECTOR: The generation of every id. It grows every time the id is freed, so a public id
+     *  (generation and id together) of a removed meeting never matches the meeting that reuses the id */
+    std::vector<unsigned> idGenerations;
+    //! VECTOR: Ids of removed meetings that can be given to new ones
+    std::vector<int> freeIds;
+    /*! DATEINDEX: The storage index. Keeps (sort key, id) pairs of all meetings ordered by date,
+     *  startHour and endHour, so date lookups are a binary search instead of a scan.
+     *  Date and time scans read only the sort keys. See setSortedVectorDateIndex() */
+    DateIndex dateIndex;
+    //! NAMEINDEX: Hash index from the exact name to meeting ids
+    NameIndex names;
+    //! WORDINDEX: Inverted index from the words in the names to meeting ids
+    WordIndex nameWords;
+    //! WORDINDEX: Inverted index from the words in the descriptions to meeting ids
+    WordIndex descriptionWords;
+    //! TRIGRAMINDEX: Trigram index of the names used for substring search
+    TrigramIndex nameTrigrams;
+    //! TRIGRAMINDEX: Trigram index of the descriptions used for substring search
+    TrigramIndex descriptionTrigrams;
+    //! OCCUPANCYCACHE: Optional bitmaps of the busy minutes of every day. See setOccupancyCache()
+    OccupancyCache occupancy;
+    //! WORKLOADINDEX: The busy minutes of every date and day of the week used by workloadStatistic()
+    WorkloadIndex workload;
+    //! SET: The pages of the paged snapshot (see PageManifest) that changed since the last savePages() or loadPages()
+    std::set<int> dirtyPages;
+    //! BOOL: Whether every page has to be written by the next savePages()
+    bool allPagesDirty;
+    //! STRING: The base path of the paged snapshot that dirtyPages is compared to
+    std::string savedPagesBase;
+    //! UNSIGNED LONG LONG: The version of that snapshot. Another version means someone else saved it
+    unsigned long long savedPagesVersion;
+
+    // SECTION: MEMORY HELPERS----------------------------------------------------------------
+
+    //! Allocates uninitialized memory for a given number of meetings
+    static Meeting* allocateMeetings(int count){
+        return static_cast<Meeting*>(::operator new(sizeof(Meeting) * count));
+    }
 
-    //! A function to resize the meeting list
-    void resizeMeetingList() {
-        // Creating a buffer to hold the info
-        Meeting* buff = new Meeting[size];
-        for (int i = 0; i < size; ++i) {
-            buff[i] = meetingList[i];
+    //! Destroys the constructed meetings and frees the memory of the meeting list
+    void freeMeetingList(){
+        if(meetingList == nullptr) return;
+        for (int i = 0; i < constructed; ++i) {
+            meetingList[i].~Meeting();
+        }
+        ::operator delete(meetingList);
+        meetingList = nullptr;
+        constructed = 0;
+    }
+
+    /*! A function to resize the meeting list to new_size. The meetings are moved into the new memory,
+     *  so only the handles of their strings are copied */
+    void resizeMeetingList(int new_size) {
+        Meeting* new_list = allocateMeetings(new_size);
+        for (int i = 0; i < current; ++i) {
+            new (&new_list[i]) Meeting(std::move(meetingList[i]));
         }
 
-        // Resizing the array
-        delete [] meetingList;
-        size *= 2;
-        meetingList = new Meeting[size];
+        freeMeetingList();
+        meetingList = new_list;
+        size = new_size;
+        constructed = current;
+    }
+
+    //! Puts a meeting at the end of the list, constructing it in place if the position is uninitialized
+    template <typename M>
+    void placeMeeting(M&& meeting){
+        if(current >= size) resizeMeetingList(size > 0 ? size * 2 : 10);
+        if(current < constructed){
+            meetingList[current] = std::forward<M>(meeting);
+        } else {
+            new (&meetingList[current]) Meeting(std::forward<M>(meeting));
+            constructed++;
+        }
+        current++;
+    }
+
+    //! Swaps the contents of two calendars
+    void swap(PersonalCalendar& other) noexcept {
+        std::swap(meetingList, other.meetingList);
+        std::swap(current, other.current);
+        std::swap(size, other.size);
+        std::swap(constructed, other.constructed);
+        slotIds.swap(other.slotIds);
+        idSlots.swap(other.idSlots);
+        idGenerations.swap(other.idGenerations);
+        freeIds.swap(other.freeIds);
+        dateIndex.swap(other.dateIndex);
+        std::swap(names, other.names);
+        std::swap(nameWords, other.nameWords);
+        std::swap(descriptionWords, other.descriptionWords);
+        std::swap(nameTrigrams, other.nameTrigrams);
+        std::swap(descriptionTrigrams, other.descriptionTrigrams);
+        std::swap(occupancy, other.occupancy);
+        std::swap(workload, other.workload);
+        dirtyPages.swap(other.dirtyPages);
+        std::swap(allPagesDirty, other.allPagesDirty);
+        savedPagesBase.swap(other.savedPagesBase);
+        std::swap(savedPagesVersion, other.savedPagesVersion);
+    }
+
+    // SECTION: INDEX HELPERS----------------------------------------------------------------
+
+    //! Adds the meeting with the given id to all search indexes. rebuildIndexes() builds the workload sums itself
+    void addToIndexes(int id, bool count_workload = true){
+        const Meeting& meeting = meetingById(id);
+        dateIndex.insert({meeting.getSortKey(), id});
+        names.add(meeting.getNameHandle(), id);
+        nameWords.add(id, meeting.getName());
+        descriptionWords.add(id, meeting.getDescription());
+        nameTrigrams.add(id, meeting.getName());
+        descriptionTrigrams.add(id, meeting.getDescription());
+        occupancy.add(meeting.getDate().getSerial(), meeting.getStartHour().getTotalMinutes(), meeting.getEndHour().getTotalMinutes());
+        if(count_workload) workload.add(meeting.getDate(), (meeting.getEndHour() - meeting.getStartHour()).getTotalMinutes());
+        if(!allPagesDirty) dirtyPages.insert(PageManifest::pageOf(meeting.getDate()));
+    }
+
+    //! Removes the meeting with the given id from all search indexes
+    void removeFromIndexes(int id){
+        const Meeting& meeting = meetingById(id);
+        dateIndex.erase({meeting.getSortKey(), id});
+        names.remove(meeting.getNameHandle(), id);
+        nameWords.remove(id, meeting.getName());
+        descriptionWords.remove(id, meeting.getDescription());
+        nameTrigrams.remove(id, meeting.getName());
+        descriptionTrigrams.remove(id, meeting.getDescription());
+        if(occupancy.isEnabled()) rebuildOccupancy(meeting.getDate());
+        workload.add(meeting.getDate(), -(meeting.getEndHour() - meeting.getStartHour()).getTotalMinutes());
+        if(!allPagesDirty) dirtyPages.insert(PageManifest::pageOf(meeting.getDate()));
+    }
+
+    //! Builds the bitmap of a single day again from the meetings that are still in the date index
+    void rebuildOccupancy(const MyDate& date){
+        occupancy.clearDay(date.getSerial());
+        for (auto it = dateBegin(date); it != dateEnd(date); ++it) {
+            occupancy.add(date.getSerial(), (int)(it->first >> 11 & 2047), (int)(it->first & 2047));
+        }
+    }
 
-        // Returning the data to the array
+    //! Gives an id to the meeting on the given position and adds it to the indexes. Freed ids are used first
+    void indexMeeting(int slot, bool count_workload = true){
+        int id;
+        if(!freeIds.empty()){
+            id = freeIds.back();
+            freeIds.pop_back();
+            idSlots[id] = slot;
+        } else {
+            id = (int)idSlots.size();
+            idSlots.push_back(slot);
+            idGenerations.push_back(0);
+        }
+        if((int)slotIds.size() <= slot) slotIds.resize(slot + 1);
+        slotIds[slot] = id;
+        addToIndexes(id, count_workload);
+    }
+
+    //! Frees an id, so the public id of its meeting stops being valid
+    void freeId(int id){
+        idSlots[id] = -1;
+        idGenerations[id]++;
+        freeIds.push_back(id);
+    }
+
+    /*! Clears the indexes and builds them again from the meetings in the array.
+     *  NOTE: All ids are freed, so the public ids given out before stop being valid */
+    void rebuildIndexes(){
+        // All ids become free. They are pushed from the largest, so the smallest ones are given out first
+        freeIds.clear();
+        for (int id = (int)idSlots.size() - 1; id >= 0; --id) {
+            if(idSlots[id] >= 0) idGenerations[id]++;
+            idSlots[id] = -1;
+            freeIds.push_back(id);
+        }
+        slotIds.clear();
+        dateIndex.clear();
+        names.clear();
+        nameWords.clear();
+        descriptionWords.clear();
+        nameTrigrams.clear();
+        descriptionTrigrams.clear();
+        occupancy.clear();
+        workload.clear();
+        dirtyPages.clear();
+        allPagesDirty = true;
+        // The meetings are in no particular order, so the date index is built as a tree and converted at the end
+        bool columnar = dateIndex.isColumnar();
+        dateIndex.setColumnar(false);
         for (int i = 0; i < current; ++i) {
-            meetingList[i] = buff[i];
+            indexMeeting(i, false);
+        }
+        dateIndex.setColumnar(columnar);
+
+        // The workload sums are built at once by many threads (see WorkloadIndex::build())
+        workload.build(current, [&](int slot, int& serial, long long& minutes){
+            const Meeting& meeting = meetingList[slot];
+            serial = meeting.getDate().getSerial();
+            minutes = (meeting.getEndHour() - meeting.getStartHour()).getTotalMinutes();
+        });
+    }
+
+    //! Returns the meeting with the given id
+    Meeting& meetingById(int id) const {
+        return meetingList[idSlots[id]];
+    }
+
+    /*! Removes the meeting on the given position. The last meeting is moved into the freed
+     *  position, so nothing has to be shifted and the indexes only need to change the moved slot */
+    void removeAt(int slot){
+        int id = slotIds[slot];
+        removeFromIndexes(id);
+        freeId(id);
+
+        int last = current - 1;
+        if(slot != last){
+            meetingList[slot] = std::move(meetingList[last]);
+            slotIds[slot] = slotIds[last];
+            idSlots[slotIds[slot]] = slot;
         }
-        delete [] buff;
+
+        // Destroying the freed position. It is kept constructed if the array was prepared for outside writes
+        if(constructed == current){
+            meetingList[last].~Meeting();
+            constructed--;
+        }
+        current--;
+    }
+
+    //! Returns the public id of the meeting on the given position. The generation is kept in the upper 32 bits
+    long long publicIdAt(int slot) const {
+        int id = slotIds[slot];
+        return (long long)idGenerations[id] << 32 | (unsigned)id;
+    }
+
+    //! Returns the position of the meeting with the given public id or -1 if the meeting was removed
+    int slotOfPublicId(long long public_id) const {
+        if(public_id < 0) return -1;
+        long long id = public_id & 0xFFFFFFFFLL;
+        if(id >= (long long)idSlots.size() || idGenerations[id] != (unsigned)(public_id >> 32)) return -1;
+        return idSlots[id];
+    }
+
+    //! Returns the first (sort key, id) pair on the given date or later
+    DateIndex::const_iterator dateBegin(const MyDate& date) const {
+        return dateIndex.lower_bound({Meeting::getDateKey(date), INT_MIN});
+    }
+
+    //! Returns the first (sort key, id) pair after the given date
+    DateIndex::const_iterator dateEnd(const MyDate& date) const {
+        return dateIndex.upper_bound({Meeting::getDateKey(date) + (1 << 22) - 1, INT_MAX});
+    }
+
+    //! Returns the position of a meeting equal to the given one or -1 if there is no such meeting
+    int findMeeting(const Meeting& meeting) const {
+        long long key = meeting.getSortKey();
+        for (auto it = dateIndex.lower_bound({key, INT_MIN}); it != dateIndex.end() && it->first == key; ++it) {
+            if(meetingById(it->second) == meeting) return idSlots[it->second];
+        }
+        return -1;
+    }
+
+    //! Replaces the meeting on the given position and moves it to its new place in the indexes
+    void replaceAt(int slot, const Meeting& new_meeting){
+        int id = slotIds[slot];
+        removeFromIndexes(id);
+        meetingList[slot] = new_meeting;
+        addToIndexes(id);
+    }
+
+    //! Returns the ids of all meetings with exactly the given name or nullptr if there are none
+    const std::vector<int>* findByName(const char* name) const {
+        int handle = StringArena::shared().find(name);
+        if(handle < 0) return nullptr;
+        return names.get(handle);
+    }
+
+    //! Returns the smallest position of a meeting with exactly the given name or -1 if there is none
+    int findFirstByName(const char* name) const {
+        const std::vector<int>* ids = findByName(name);
+        if(ids == nullptr) return -1;
+        int first = INT_MAX;
+        for (int id : *ids) {
+            first = std::min(first, idSlots[id]);
+        }
+        return first;
+    }
+
+    /*! Returns the sorted positions of all meetings whose text contains the word. The results are exactly
+     *  the same as a strstr scan over the array, but only the candidates from the trigram index are checked.
+     *  Words that are too short for the index fall back to the scan */
+    std::vector<int> findSubstring(const TrigramIndex& index, char* (Meeting::*text)() const, const char* word) const {
+        std::vector<int> slots;
+        std::vector<int> candidates;
+        if(index.findCandidates(word, candidates)){
+            for (int id : candidates) {
+                if(strstr((meetingById(id).*text)(), word) != NULL) slots.push_back(idSlots[id]);
+            }
+            std::sort(slots.begin(), slots.end());
+        } else {
+            for (int i = 0; i < current; ++i) {
+                if(strstr((meetingList[i].*text)(), word) != NULL) slots.push_back(i);
+            }
+        }
+        return slots;
+    }
+
+    /*! Removes all meetings on the given positions in one pass. The positions are removed from the
+     *  last to the first, so the meeting that removeAt() moves into a freed position is never one of them */
+    void removeAllAt(std::vector<int>& slots){
+        std::sort(slots.begin(), slots.end());
+        for (int i = (int)slots.size() - 1; i >= 0; --i) {
+            removeAt(slots[i]);
+        }
+    }
+
+    /*! Takes the meetings of a calendar that was just loaded. The occupancy cache and the layout of the
+     *  date index are settings of this calendar and not of the file, so they are given to the loaded one first.
+     *  The ids of the loaded calendar start from generation 0, so they are moved above the generations of this one.
+     *  Then no public id given out before the load matches a loaded meeting, the same as after setMeetingList() */
+    void replaceWith(PersonalCalendar& loaded){
+        loaded.setOccupancyCache(occupancy.isEnabled());
+        loaded.setSortedVectorDateIndex(dateIndex.isColumnar());
+
+        // Ids that only this calendar used are kept as free ids, so their generations are not lost
+        int loaded_ids = (int)loaded.idSlots.size();
+        if((int)idSlots.size() > loaded_ids){
+            loaded.idSlots.resize(idSlots.size(), -1);
+            loaded.idGenerations.resize(idSlots.size(), 0);
+            for (int id = (int)idSlots.size() - 1; id >= loaded_ids; --id) {
+                loaded.freeIds.insert(loaded.freeIds.begin(), id);
+            }
+        }
+        for (size_t id = 0; id < idGenerations.size(); ++id) {
+            loaded.idGenerations[id] += idGenerations[id] + 1;
+        }
+        swap(loaded);
     }
 
 public:
     // SECTION: CONSTRUCTORS------------------------------------------------------------------
 
     //! Constructor with all parameters for PersonalCalendar class
-    PersonalCalendar(Meeting *meetingList, int current, int size) :current(current), size(size) {
-        this->meetingList = new Meeting[size];
+    PersonalCalendar(Meeting *meetingList, int current, int size) :current(current), size(size), allPagesDirty(true), savedPagesVersion(0) {
+        this->meetingList = nullptr;
+        this->constructed = 0;
         setMeetingList(meetingList, current, size);
     }
 
     //! Default constructor for PersonalCalendar class. Creates meeting list with size 10
-    PersonalCalendar(){
+    PersonalCalendar() : allPagesDirty(true), savedPagesVersion(0){
         this->size = 10;
         this->current = 0;
-        this->meetingList = new Meeting[this->size];
+        this->constructed = 0;
+        this->meetingList = allocateMeetings(this->size);
+    }
+
+    //! Copy constructor for the PersonalCalendar class. The indexes are copied instead of being built again
+    PersonalCalendar(const PersonalCalendar &other)
+            : current(other.current), size(other.size), constructed(other.current),
+              slotIds(other.slotIds), idSlots(other.idSlots), idGenerations(other.idGenerations),
+              freeIds(other.freeIds), dateIndex(other.dateIndex), names(other.names),
+              nameWords(other.nameWords), descriptionWords(other.descriptionWords),
+              nameTrigrams(other.nameTrigrams), descriptionTrigrams(other.descriptionTrigrams),
+              occupancy(other.occupancy), workload(other.workload), dirtyPages(other.dirtyPages),
+              allPagesDirty(other.allPagesDirty), savedPagesBase(other.savedPagesBase),
+              savedPagesVersion(other.savedPagesVersion){
+        meetingList = allocateMeetings(size);
+        for (int i = 0; i < current; ++i) {
+            new (&meetingList[i]) Meeting(other.meetingList[i]);
+        }
     }
 
-    //! Copy constructor for the PersonalCalendar class
-    PersonalCalendar(const PersonalCalendar &other){
-        setSize(other.size);
-        setCurrent(other.current);
-        meetingList = new Meeting[other.size];
-        setMeetingList(other.meetingList, other.current, other.size);
+    //! Move constructor for the PersonalCalendar class. Takes the memory of the other calendar and leaves it empty
+    PersonalCalendar(PersonalCalendar &&other) noexcept
+            : meetingList(nullptr), current(0), size(0), constructed(0), allPagesDirty(true), savedPagesVersion(0){
+        swap(other);
     }
 
     //! Destructor for PersonalCalendar class
     ~PersonalCalendar() {
-        delete [] meetingList;
+        freeMeetingList();
+    }
+
+    //! Overloading of the = operator. Works for both copying and moving through the copy and swap idiom
+    PersonalCalendar& operator = (PersonalCalendar other){
+        swap(other);
+        return *this;
     }
 
 
 
 
     // SECTION: GETTERS AND SETTERS-----------------------------------------------------------
-    //! Getter for the meeting array
-    Meeting *getMeetingList() const {
+    /*! Getter for the meeting array. The meetings in it are in no particular order.
+     *  All size positions are constructed before returning, so the array can be used as a buffer.
+     *  NOTE: After writing to the array call setCurrent() or setMeetingList() so the indexes are rebuilt */
+    Meeting *getMeetingList() {
+        for (; constructed < size; ++constructed) {
+            new (&meetingList[constructed]) Meeting();
+        }
+        return meetingList;
+    }
+
+    /*! Getter for the meeting array of a calendar that is only read. The meetings are in no particular order.
+     *  NOTE: Only the first getCurrent() positions can be read. It changes nothing, so concurrent readers can call it */
+    const Meeting *getMeetingList() const {
         return meetingList;
     }
 
@@ -91,136 +476,210 @@ public:
         return size;
     }
 
-    //! Getter for meeting by name. NOTE: Throws invalid_argument exception
-    Meeting getByName(char* new_name){
-        for (int i = 0; i < current; ++i) {
-            if(strcmp(meetingList[i].getName(), new_name) == 0){
-                return meetingList[i];
-            }
+    //! Getter for meeting by name. Uses the name index. NOTE: Throws invalid_argument exception
+    Meeting getByName(char* new_name) const {
+        int slot = findFirstByName(new_name);
+        if(slot >= 0){
+            return meetingList[slot];
         }
         throw std::invalid_argument( "Meeting not found" );
     }
 
 
-    //! Getter for meeting by date. NOTE: Throws invalid_argument exception
-    Meeting getByDate(const MyDate& date){
-        for (int i = 0; i < current; ++i) {
-            if(meetingList[i].getDate() == date){
-                return meetingList[i];
-            }
+    //! Getter for first meeting that has a given word in the description. Uses the word index. NOTE: Throws invalid_argument exception
+    Meeting getFirstByTokenInDescription(char* word) const {
+        const PostingList* ids = descriptionWords.find(word);
+        if(ids != nullptr){
+            return meetingById(ids->smallest());
+        }
+        throw std::invalid_argument( "Meeting not found" );
+    }
+
+    /*! Getter for all meetings that have a given word in the description. Unlike getAllByWordInDescription()
+     *  it matches only whole words and costs as much as the number of matches. NOTE: Returns the number of matches */
+    int getAllByTokenInDescription(Meeting* newMeetingList, char* word) const {
+        const PostingList* list = descriptionWords.find(word);
+        if(list == nullptr) return 0;
+        std::vector<int> ids = list->sorted();
+        for (size_t i = 0; i < ids.size(); ++i) {
+            newMeetingList[i] = meetingById(ids[i]);
+        }
+        return (int)ids.size();
+    }
+
+    //! The same as getAllByTokenInDescription() but for the names. NOTE: Returns the number of matches
+    int getAllByTokenInName(Meeting* newMeetingList, char* word) const {
+        const PostingList* list = nameWords.find(word);
+        if(list == nullptr) return 0;
+        std::vector<int> ids = list->sorted();
+        for (size_t i = 0; i < ids.size(); ++i) {
+            newMeetingList[i] = meetingById(ids[i]);
+        }
+        return (int)ids.size();
+    }
+
+    //! Getter for the earliest meeting on a given date. NOTE: Throws invalid_argument exception
+    Meeting getByDate(const MyDate& date) const {
+        auto it = dateBegin(date);
+        if(it != dateEnd(date)){
+            return meetingById(it->second);
         }
         throw std::invalid_argument( "Meeting not found" );
     }
 
 
     //! Getter for first matched meeting by word in the description. NOTE: Throws invalid_argument exception
-    Meeting getFirstByWordInDescription(char* word){
-        for (int i = 0; i < current; ++i) {
-            if(strstr(meetingList[i].getDescription(), word) != NULL){
-                return meetingList[i];
-            }
+    Meeting getFirstByWordInDescription(char* word) const {
+        std::vector<int> slots = findSubstring(descriptionTrigrams, &Meeting::getDescription, word);
+        if(!slots.empty()){
+            return meetingList[slots.front()];
         }
         throw std::invalid_argument( "Meeting not found" );
     }
 
     //! Getter for all meeting which description contain a given word. NOTE: Returns the number of matches
-    int getAllByWordInDescription(Meeting* newMeetingList, char* word){
-        int j = 0;
-        for (int i = 0; i < current; ++i) {
-            if(strstr(meetingList[i].getDescription(), word) != NULL){
-                newMeetingList[j] = meetingList[i];
-                j++;
-            }
+    int getAllByWordInDescription(Meeting* newMeetingList, char* word) const {
+        std::vector<int> slots = findSubstring(descriptionTrigrams, &Meeting::getDescription, word);
+        for (size_t j = 0; j < slots.size(); ++j) {
+            newMeetingList[j] = meetingList[slots[j]];
         }
-        return j;
+        return (int)slots.size();
     }
 
-    int getAllByWordInName(Meeting* newMeetingList, char* word){
+    //! Getter for all meeting which name contain a given word. NOTE: Returns the number of matches
+    int getAllByWordInName(Meeting* newMeetingList, char* word) const {
+        std::vector<int> slots = findSubstring(nameTrigrams, &Meeting::getName, word);
+        for (size_t j = 0; j < slots.size(); ++j) {
+            newMeetingList[j] = meetingList[slots[j]];
+        }
+        return (int)slots.size();
+    }
+
+    //! Getter for all meetings on a given date sorted by startHour and endHour. NOTE: Returns the number of matches
+    int getAllByDate(Meeting* newMeetingList, const MyDate& date) const {
         int j = 0;
-        for (int i = 0; i < current; ++i) {
-            if(strstr(meetingList[i].getName(), word) != NULL){
-                newMeetingList[j] = meetingList[i];
-                j++;
-            }
+        for (auto it = dateBegin(date); it != dateEnd(date); ++it) {
+            newMeetingList[j] = meetingById(it->second);
+            j++;
         }
         return j;
     }
 
-    int getAllByDate(Meeting* newMeetingList, const MyDate& date){
+    //! Getter for all meetings between two dates (inclusive) in sorted order. NOTE: Returns the number of matches
+    int getAllInPeriod(Meeting* newMeetingList, const MyDate& s_date, const MyDate& e_date) const {
         int j = 0;
-        for (int i = 0; i < current; ++i) {
-            if(meetingList[i].getDate() == date){
-                newMeetingList[j] = meetingList[i];
-                j++;
-            }
+        for (auto it = dateBegin(s_date); it != dateEnd(e_date); ++it) {
+            newMeetingList[j] = meetingById(it->second);
+            j++;
         }
         return j;
     }
 
-    //! Setter for the meeting list
+    //! Setter for the meeting list. Copies the first new_current meetings and rebuilds the indexes
     void setMeetingList(Meeting *newMeetingList, int new_current, int new_size) {
-        delete [] this->meetingList;
-        this->meetingList = new Meeting[new_size];
-        for (int i = 0; i < new_current+1; ++i) {
-            this->meetingList[i] = newMeetingList[i];
+        if(new_size < new_current) new_size = new_current;
+        if(new_size < 1) new_size = 1;
+        Meeting* new_list = allocateMeetings(new_size);
+        for (int i = 0; i < new_current; ++i) {
+            new (&new_list[i]) Meeting(newMeetingList[i]);
         }
+        freeMeetingList();
+        this->meetingList = new_list;
+        this->current = new_current;
+        this->size = new_size;
+        this->constructed = new_current;
+        rebuildIndexes();
     }
 
-    //! Setter for the current element number
+    //! Setter for the current element number. Rebuilds the indexes from the first new_current meetings
     void setCurrent(int new_current) {
+        if(new_current < 0 || new_current > size) throw std::invalid_argument( "The number of meetings is not in the array range" );
+        for (; constructed < new_current; ++constructed) {
+            new (&meetingList[constructed]) Meeting();
+        }
         this->current = new_current;
+        rebuildIndexes();
     }
 
-    //! Setter for the size of the array
+    //! Makes the array big enough for new_size meetings, so adding that many meetings never resizes it
+    void reserve(int new_size){
+        if(new_size > size) resizeMeetingList(new_size);
+    }
+
+    /*! Setter for the size of the array. The meetings are moved to a new array of that size, because
+     *  getMeetingList() and adding meetings trust the size to be the allocated length.
+     *  NOTE: Throws invalid_argument exception if the new size cannot hold the current meetings */
     void setSize(int new_size) {
-        this->size = new_size;
+        if(new_size < current || new_size < 1) throw std::invalid_argument( "The size cannot hold the meetings of the calendar" );
+        if(new_size != size) resizeMeetingList(new_size);
     }
 
     //! Returns the earliest meeting found in the calendar
-    Meeting getEarliestMeeting(){
+    Meeting getEarliestMeeting() const {
         // If the array is empty throws exception
         if(current <= 0) throw std::invalid_argument( "Meeting list is empty so minimal date cannot be found" );
-        // Sets the first element as minimal
-        Meeting* min = &meetingList[0];
-        // Goes through all elements and if it finds an element that is smaller it sets it as a minimal
-        for (int i = 0; i < current; ++i) {
-            if(meetingList[i] < *min) min = &meetingList[i];
-        }
-        return *min;
+        // The index is sorted, so the first element is the minimal
+        return meetingById(dateIndex.begin()->second);
     }
 
     // SECTION: HELPER FUNCTIONS----------------------------------------------------------
 
-    //! A function to add a new meeting to the meeting list. Resizes the list if necessary
-    void addMeeting(const Meeting& meeting){
-        if(current >= size) resizeMeetingList();
-        meetingList[current] = meeting;
-        current++;
+    /*! A function to add a new meeting to the meeting list. Resizes the list if necessary.
+     *  NOTE: Returns the id of the meeting. It stays the same until the meeting is removed */
+    long long addMeeting(const Meeting& meeting){
+        placeMeeting(meeting);
+        indexMeeting(current - 1);
+        return publicIdAt(current - 1);
     }
 
-    //! This function removes given element from the array
-    bool removeMeeting(const Meeting& meeting){
-        // Going through the whole array
-        for (int i = 0; i < current; i++)
-        {
-
-            // Checking if the elements match
-            if (meetingList[i] == meeting)
-            {
-                // Going through remaining elements
-                for ( ; i < current - 1; i++)
-                {
-                    // Assign the next element to current location.
-                    meetingList[i] = meetingList[i + 1];
-                }
+    //! The same as addMeeting() but moves the meeting into the list instead of copying it
+    long long addMeeting(Meeting&& meeting){
+        placeMeeting(std::move(meeting));
+        indexMeeting(current - 1);
+        return publicIdAt(current - 1);
+    }
 
-                // Remove the last element as it has been moved to previous index.
-                meetingList[current - 1] = Meeting();
-                current = current - 1;
-                return true;
-            }
-        }
-            return false;
+    //! Returns the id of a meeting equal to the given one or -1 if there is no such meeting
+    long long findId(const Meeting& meeting) const {
+        int slot = findMeeting(meeting);
+        if(slot < 0) return -1;
+        return publicIdAt(slot);
+    }
+
+    //! Checks if there is a meeting with the given id
+    bool containsId(long long id) const {
+        return slotOfPublicId(id) >= 0;
+    }
+
+    //! Getter for meeting by id. NOTE: Throws invalid_argument exception
+    const Meeting& getById(long long id) const {
+        int slot = slotOfPublicId(id);
+        if(slot < 0) throw std::invalid_argument( "Meeting not found" );
+        return meetingList[slot];
+    }
+
+    //! Removes the meeting with the given id without comparing or shifting any meetings. NOTE: Returns false if there is no such meeting
+    bool removeById(long long id){
+        int slot = slotOfPublicId(id);
+        if(slot < 0) return false;
+        removeAt(slot);
+        return true;
+    }
+
+    //! Replaces the meeting with the given id. The meeting keeps its id. NOTE: Returns false if there is no such meeting
+    bool updateById(long long id, const Meeting& new_meeting){
+        int slot = slotOfPublicId(id);
+        if(slot < 0) return false;
+        replaceAt(slot, new_meeting);
+        return true;
+    }
+
+    //! This function removes given element from the array. The element is found through the date index
+    bool removeMeeting(const Meeting& meeting){
+        int slot = findMeeting(meeting);
+        if(slot < 0) return false;
+        removeAt(slot);
+        return true;
     }
 
     /*! A function to save the class into a binary file*/
@@ -233,40 +692,190 @@ public:
         }
     }
 
-    /*! A function to load the class from a binary file*/
+    /*! A function to load the class from a binary file. The file is read in large blocks and every meeting
+     *  is built once, straight in the array. The lengths in the file are checked against its size,
+     *  so a corrupted file cannot cause huge allocations.
+     *  NOTE: Throws invalid_argument exception if the file is corrupted. The calendar is not changed then */
     void load(ifstream& file){
-        // Getting the size of the array first
+        BufferedReader reader(file);
+
+        // Getting the size of the array first. Every meeting takes at least two lengths and seven ints
+        const size_t min_meeting_size = 2 * sizeof(size_t) + 7 * sizeof(int);
         int new_current = 0;
-        file.read((char *)&new_current, sizeof(int));
-        current = new_current;
-        Meeting* buffer = new Meeting[current+1];
-        for (int i = 0; i < current; ++i) {
-            buffer[i].load(file);
+        if(!reader.read(&new_current, sizeof(int)) || new_current < 0
+           || (size_t)new_current > reader.getRemaining() / min_meeting_size){
+            throw invalid_argument("The calendar file is corrupted");
+        }
+
+        PersonalCalendar loaded;
+        // The count is checked against the file size above, but doubling it as an int could still overflow
+        loaded.reserve((int)std::min<size_t>((size_t)new_current * 2, INT_MAX));
+        std::string name, description;
+        for (int i = 0; i < new_current; ++i) {
+            size_t name_size = 0, description_size = 0;
+            int fields[7];
+            bool complete = reader.read(&name_size, sizeof(size_t))
+                            && name_size <= reader.getRemaining() && reader.readString(name, name_size)
+                            && reader.read(&description_size, sizeof(size_t))
+                            && description_size <= reader.getRemaining() && reader.readString(description, description_size)
+                            && reader.read(fields, sizeof(fields));
+            if(!complete) throw invalid_argument("The calendar file is corrupted");
+
+            // The constructors of the date and the hours check the values
+            loaded.addMeeting(Meeting(&name[0], &description[0],
+                                      MyDate(fields[0], fields[1], fields[2]),
+                                      MyHour(fields[3], fields[4]),
+                                      MyHour(fields[5], fields[6])));
         }
-        setMeetingList(buffer, current, current*2);
-        delete [] buffer;
+        reader.rewindUnread();
+        replaceWith(loaded);
     }
 
-    //! A function to print the class
-    void print(){
-        cout << "Personal calendar: " << endl << endl;
-        for (int i = 0; i < current; ++i) {
-            meetingList[i].print();
-            cout << endl;
+    /*! Saves the calendar in the CalendarFile format. The meetings are written sorted by date and hour,
+     *  so the file can be searched by date without loading it. NOTE: Throws invalid_argument exception */
+    void saveFile(const char* path) const {
+        CalendarFile::write(path, [&](auto action){
+            for (const std::pair<long long, int>& entry : dateIndex) {
+                action(meetingById(entry.second));
+            }
+        });
+    }
+
+    /*! Replaces the meetings of the calendar with the ones from a CalendarFile. The checksum of the file is checked first.
+     *  NOTE: Throws invalid_argument exception if the file is not a valid calendar file or it is corrupted */
+    void loadFile(const char* path){
+        CalendarFile file(path);
+        if(!file.verify()) throw std::invalid_argument( "The calendar file is corrupted" );
+        PersonalCalendar loaded;
+        loaded.reserve((int)std::min<size_t>(file.getCount(), INT_MAX));
+        for (size_t i = 0; i < file.getCount(); ++i) {
+            loaded.addMeeting(file.getMeeting(i));
+        }
+        replaceWith(loaded);
+    }
+
+    //! Converts a file written by save() into the CalendarFile format. NOTE: Throws invalid_argument exception
+    static void importLegacy(const char* legacy_path, const char* path){
+        ifstream legacy(legacy_path, ios::in | ios::binary);
+        if(!legacy) throw invalid_argument("Couldn't open file");
+        PersonalCalendar calendar;
+        calendar.load(legacy);
+        calendar.saveFile(path);
+    }
+
+    //! Returns the number of pages that the next savePages() will write. NOTE: Returns -1 if it will write all of them
+    int getDirtyPageCount() const {
+        return allPagesDirty ? -1 : (int)dirtyPages.size();
+    }
+
+    /*! Saves the calendar as a paged snapshot (see PageManifest). Only the pages that changed since the last
+     *  savePages() or loadPages() are written, so a small change to a big calendar writes a few small files.
+     *  NOTE: The changes are tracked for a single snapshot. The first save after the calendar was loaded from
+     *  somewhere else, or a save to another base path, writes every page. Throws invalid_argument exception */
+    void savePages(const char* base){
+        PageManifest manifest;
+        bool found = manifest.load(base);
+
+        // Collecting the pages to write. Pages that are in the manifest but have no meetings any more are written empty
+        std::set<int> pages;
+        if(allPagesDirty || !found || manifest.getVersion() != savedPagesVersion || savedPagesBase != base){
+            for (const std::pair<const int, unsigned long long>& page : manifest.getPages()) {
+                pages.insert(page.first);
+            }
+            for (auto it = dateIndex.begin(); it != dateIndex.end(); ) {
+                int page = (int)((it->first >> 22) / PageManifest::PAGE_DAYS);
+                pages.insert(page);
+                it = dateIndex.lower_bound({(long long)(page + 1) * PageManifest::PAGE_DAYS << 22, INT_MIN});
+            }
+        } else {
+            pages = dirtyPages;
+        }
+
+        // Writing the new page files next to the old ones
+        unsigned long long version = manifest.getVersion() + 1;
+        std::vector<std::string> old_files;
+        for (int page : pages) {
+            if(manifest.getPage(page) != 0) old_files.push_back(PageManifest::pagePath(base, page, manifest.getPage(page)));
+            auto begin = dateBegin(PageManifest::firstDateOf(page));
+            auto end = dateEnd(PageManifest::lastDateOf(page));
+            manifest.setPage(page, version, begin == end);
+            if(begin == end) continue;
+
+            std::string path = PageManifest::pagePath(base, page, version);
+            CalendarFile::write(path.c_str(), [&](auto action){
+                for (auto it = begin; it != end; ++it) {
+                    action(meetingById(it->second));
+                }
+            });
+        }
+
+        // The new manifest makes the new pages the snapshot in one step. Only then the old files can go
+        manifest.setVersion(version);
+        manifest.save(base);
+        for (const std::string& path : old_files) {
+            std::remove(path.c_str());
+        }
+        dirtyPages.clear();
+        allPagesDirty = false;
+        savedPagesBase = base;
+        savedPagesVersion = version;
+    }
+
+    /*! Replaces the meetings of the calendar with the ones from a paged snapshot.
+     *  NOTE: Throws invalid_argument exception if there is no snapshot or it is corrupted */
+    void loadPages(const char* base){
+        PageManifest manifest;
+        if(!manifest.load(base)) throw std::invalid_argument( "Couldn't open file" );
+        PersonalCalendar loaded;
+        for (const std::pair<const int, unsigned long long>& page : manifest.getPages()) {
+            CalendarFile file(PageManifest::pagePath(base, page.first, page.second).c_str());
+            if(!file.verify()) throw std::invalid_argument( "The calendar file is corrupted" );
+            loaded.reserve((int)std::min<size_t>((size_t)loaded.getCurrent() + file.getCount(), INT_MAX));
+            for (size_t i = 0; i < file.getCount(); ++i) {
+                loaded.addMeeting(file.getMeeting(i));
+            }
         }
+        replaceWith(loaded);
+        dirtyPages.clear();
+        allPagesDirty = false;
+        savedPagesBase = base;
+        savedPagesVersion = manifest.getVersion();
+    }
+
+    /*! A function to print the class. The meetings are printed sorted by date and hour.
+     *  The text is built in one reused buffer that is written out in large blocks */
+    void print() const {
+        std::string buffer;
+        buffer.reserve(PRINT_BUFFER_SIZE + 1024);
+        buffer.append("Personal calendar: \n\n");
+        for (auto it = dateIndex.begin(); it != dateIndex.end(); ++it) {
+            meetingById(it->second).appendTo(buffer);
+            buffer.append("\n");
+            if(buffer.size() >= PRINT_BUFFER_SIZE){
+                cout.write(buffer.data(), (streamsize)buffer.size());
+                buffer.clear();
+            }
+        }
+        cout.write(buffer.data(), (streamsize)buffer.size());
+        cout.flush();
     }
 
 
     // SECTION: BUSINESS LOGIC------------------------------------------------
 
-    //! Books a meeting with given name, description, date, startHour and endHour
-    void bookMeeting(char* new_name, char* new_description, const MyDate& new_date, const MyHour& new_start, const MyHour& new_end){
+    /*! Books a meeting with given name, description, date, startHour and endHour.
+     *  In strict mode a meeting that overlaps with another one is not booked.
+     *  NOTE: Throws invalid_argument exception if strict is true and there is a conflict */
+    void bookMeeting(char* new_name, char* new_description, const MyDate& new_date, const MyHour& new_start, const MyHour& new_end, bool strict = false){
+        if(strict && !isFree(new_date, new_start, new_end)) throw std::invalid_argument( "The meeting conflicts with another meeting" );
         addMeeting(Meeting(new_name, new_description, new_date, new_start, new_end));
     }
 
-    //! Removes the first meeting that it finds with the given name
+    //! Removes the first meeting that it finds with the given name. NOTE: Throws invalid_argument exception
     void removeMeetingByName(char* name){
-        removeMeeting(getByName(name));
+        int slot = findFirstByName(name);
+        if(slot < 0) throw std::invalid_argument( "Meeting not found" );
+        removeAt(slot);
     }
 
     //! Removes the first meeting that it finds on a given date
@@ -281,115 +890,259 @@ public:
 
     //! Removes all meetings that have a certain word in their description
     void removeAllMeetingsWithWordInDescription(char* word){
-        Meeting* buffer = new Meeting[current];
-        int buff_size = getAllByWordInDescription(buffer, word);
-        for (int i = 0; i < buff_size; ++i) {
-            removeMeeting(buffer[i]);
+        std::vector<int> slots = findSubstring(descriptionTrigrams, &Meeting::getDescription, word);
+        removeAllAt(slots);
+    }
+
+    //! Removes all meetings that have a given whole word in their description. Uses the word index
+    void removeAllMeetingsWithTokenInDescription(char* word){
+        const PostingList* ids = descriptionWords.find(word);
+        if(ids == nullptr) return;
+        std::vector<int> slots;
+        ids->forEach([&](int id){
+            slots.push_back(idSlots[id]);
+        });
+        removeAllAt(slots);
+    }
+
+    /*! Turns the bitmaps of the busy minutes on or off. With them findFreeHours() and isFree() look at
+     *  a few words per day instead of the meetings of the day. They are kept up to date by all changes */
+    void setOccupancyCache(bool enabled){
+        occupancy.setEnabled(enabled);
+        for (auto it = dateIndex.begin(); it != dateIndex.end(); ++it) {
+            occupancy.add((int)(it->first >> 22), (int)(it->first >> 11 & 2047), (int)(it->first & 2047));
         }
-        delete [] buffer;
     }
 
-    PersonalCalendar getDailyProgram(const MyDate& date){
-        PersonalCalendar buffer = PersonalCalendar(*this);
-        PersonalCalendar result = PersonalCalendar();
+    /*! Switches the date index between a tree and two sorted vectors. With the vectors the sort keys, which hold
+     *  the date and the hours, are kept in one sorted array and the ids in another (the columnar layout of DateIndex).
+     *  The date and time scans (getAllByDate(), getEarliestMeeting(), findFreeHours(), getConflicts() and the others)
+     *  read the keys one after another and touch a Meeting only when they return it.
+     *  NOTE: Only the date index changes. The meetings themselves stay an array of Meeting objects. Adding or removing
+     *  a meeting that is not the last by date costs O(n), because it moves the rest of both vectors, so this fits
+     *  calendars that are read much more than changed */
+    void setSortedVectorDateIndex(bool enabled){
+        dateIndex.setColumnar(enabled);
+    }
 
-        Meeting min;
+    //! Checks if the date index is kept in sorted vectors
+    bool isSortedVectorDateIndex() const {
+        return dateIndex.isColumnar();
+    }
 
-        int s = buffer.current;
+    //! Checks if no meeting takes any time between s_hour and e_hour of a given date
+    bool isFree(const MyDate& date, const MyHour& s_hour, const MyHour& e_hour) const {
+        int start = s_hour.getTotalMinutes();
+        int end = e_hour.getTotalMinutes();
+        if(start >= end) return true;
+        if(occupancy.isEnabled()) return occupancy.isFree(date.getSerial(), start, end);
+
+        // The meetings are sorted by startHour, so the ones starting after the end are not checked
+        long long limit = Meeting::getDateKey(date) | (long long)end << 11;
+        for (auto it = dateBegin(date); it != dateIndex.end() && it->first < limit; ++it) {
+            int meeting_start = (int)(it->first >> 11 & 2047);
+            int meeting_end = (int)(it->first & 2047);
+            if(meeting_end > meeting_start && meeting_end > start && meeting_start < end) return false;
+        }
+        return true;
+    }
 
-        for (int i = 0; i < s; ++i) {
-            min = buffer.getEarliestMeeting();
-            if(min.getDate() == date){
-                result.addMeeting(min);
+    //! Checks if a meeting overlaps with any meeting in the calendar
+    bool hasConflict(const Meeting& meeting) const {
+        return !isFree(meeting.getDate(), meeting.getStartHour(), meeting.getEndHour());
+    }
+
+    /*! Returns the ids of every two meetings between two dates (inclusive) that overlap. A single sweep goes
+     *  through the date index and keeps the meetings that have not ended yet, so the cost is the number of
+     *  meetings in the period plus the number of conflicts. The pairs are in the order of their later meeting */
+    std::vector<std::pair<long long, long long>> getConflicts(const MyDate& s_date, const MyDate& e_date) const {
+        std::vector<std::pair<long long, long long>> conflicts;
+        // The (end, slot) pairs of the meetings of the current day that started earlier
+        std::vector<std::pair<int, int>> active;
+        long long day_key = -1;
+        for (auto it = dateBegin(s_date); it != dateEnd(e_date); ++it) {
+            int start = (int)(it->first >> 11 & 2047);
+            int end = (int)(it->first & 2047);
+            // Meetings without length take no time
+            if(end <= start) continue;
+            if((it->first >> 22) != day_key){
+                day_key = it->first >> 22;
+                active.clear();
+            }
+
+            // Dropping the meetings that ended and reporting the rest, so every kept meeting is a conflict
+            int slot = idSlots[it->second];
+            size_t kept = 0;
+            for (const std::pair<int, int>& other : active) {
+                if(other.first <= start) continue;
+                conflicts.push_back({publicIdAt(other.second), publicIdAt(slot)});
+                active[kept++] = other;
             }
-            buffer.removeMeeting(min);
+            active.resize(kept);
+            active.push_back({end, slot});
         }
+        return conflicts;
+    }
 
+    /*! Returns the groups of meetings between two dates (inclusive) that overlap directly or through other meetings
+     *  of the group. Every group has at least two meetings and its ids are sorted by date and startHour */
+    std::vector<std::vector<long long>> getConflictClusters(const MyDate& s_date, const MyDate& e_date) const {
+        std::vector<std::vector<long long>> clusters;
+        std::vector<long long> cluster;
+        long long day_key = -1;
+        // The latest end of the meetings in the current group
+        int cluster_end = 0;
+        for (auto it = dateBegin(s_date); it != dateEnd(e_date); ++it) {
+            int start = (int)(it->first >> 11 & 2047);
+            int end = (int)(it->first & 2047);
+            if(end <= start) continue;
+
+            // A new group starts on every new day and after every free minute
+            if((it->first >> 22) != day_key || start >= cluster_end){
+                if(cluster.size() > 1) clusters.push_back(cluster);
+                cluster.clear();
+                day_key = it->first >> 22;
+                cluster_end = end;
+            }
+            cluster.push_back(publicIdAt(idSlots[it->second]));
+            cluster_end = std::max(cluster_end, end);
+        }
+        if(cluster.size() > 1) clusters.push_back(cluster);
+        return clusters;
+    }
+
+    //! Returns a new calendar containing only the meetings from a given date
+    PersonalCalendar getDailyProgram(const MyDate& date) const {
+        PersonalCalendar result = PersonalCalendar();
+        for (auto it = dateBegin(date); it != dateEnd(date); ++it) {
+            result.addMeeting(meetingById(it->second));
+        }
         return result;
+    }
 
+    //! Returns the number of meetings on a given date
+    int countByDate(const MyDate& date) const {
+        return (int)distanceOf(dateBegin(date), dateEnd(date));
     }
 
-    void updateAllWithName(char* new_name, Meeting new_meeting){
-        for (int i = 0; i < current; ++i) {
-            if(strcmp(meetingList[i].getName(), new_name) == 0){
-                meetingList[i].setMeeting(new_meeting.getName(), new_meeting.getDescription(), new_meeting.getDate(), new_meeting.getStartHour(), new_meeting.getEndHour());
-            }
+    //! Returns the number of meetings between two dates (inclusive)
+    int countInPeriod(const MyDate& s_date, const MyDate& e_date) const {
+        return (int)distanceOf(dateBegin(s_date), dateEnd(e_date));
+    }
+
+    /*! Puts pointers to the meetings of a given date into dailyList sorted by startHour and endHour.
+     *  Nothing is copied, so the pointers are valid only until the calendar is changed.
+     *  NOTE: Returns the number of meetings. Use countByDate() to size the list */
+    int getDailyProgram(const Meeting** dailyList, const MyDate& date) const {
+        int j = 0;
+        for (auto it = dateBegin(date); it != dateEnd(date); ++it) {
+            dailyList[j] = &meetingById(it->second);
+            j++;
         }
+        return j;
     }
 
-    void updateAllByDateAndHour(const MyDate& new_date, const MyHour& new_start, const Meeting& new_meeting){
-        for (int i = 0; i < current; ++i) {
-            if(meetingList[i].getDate() == new_date && meetingList[i].getStartHour() == new_start){
-                meetingList[i].setMeeting(new_meeting.getName(), new_meeting.getDescription(), new_meeting.getDate(), new_meeting.getStartHour(), new_meeting.getEndHour());
-            }
+    /*! The same as getDailyProgram() but for all days between two dates (inclusive).
+     *  The meetings are sorted by date first, so every day is a continuous part of the list.
+     *  NOTE: Returns the number of meetings. Use countInPeriod() to size the list */
+    int getProgramForPeriod(const Meeting** list, const MyDate& s_date, const MyDate& e_date) const {
+        int j = 0;
+        for (auto it = dateBegin(s_date); it != dateEnd(e_date); ++it) {
+            list[j] = &meetingById(it->second);
+            j++;
         }
+        return j;
     }
 
-    /*! This function finds a free hour in a given time period and duration*/
-    Meeting findFreeHour(MyDate s_date, const MyDate& e_date, const MyHour& s_hour, const MyHour& e_hour,const MyHour& duration){
-        if(s_date > e_date || s_hour > e_hour) throw invalid_argument("The time range given to findFreeHour() is invalid");
+    //! Replaces all meetings with the given name with new_meeting. Uses the name index
+    void updateAllWithName(char* new_name, Meeting new_meeting){
+        const std::vector<int>* ids = findByName(new_name);
+        if(ids == nullptr) return;
+        // Copying the ids first, because updating the meetings changes the index
+        std::vector<int> matches = *ids;
+        for (int id : matches) {
+            replaceAt(idSlots[id], new_meeting);
+        }
+    }
 
-        while (s_date <= e_date){
-            // Creating a new personal calendar containing only the meetings from the current date sorted
-            PersonalCalendar daily = getDailyProgram(s_date);
-
-            // If the daily is empty that means the whole day is free, so we return the first free hour
-            if(daily.current == 0){
-                return Meeting((char*)"Free Hour",
-                               (char*)"This meeting contains free hour",
-                               s_date,
-                               s_hour,
-                               s_hour + duration
-                );
+    void updateAllByDateAndHour(const MyDate& new_date, const MyHour& new_start, const Meeting& new_meeting){
+        // Collecting the matches first, because updating them changes their place in the index
+        std::vector<int> matches;
+        for (auto it = dateBegin(new_date); it != dateEnd(new_date); ++it) {
+            if(meetingById(it->second).getStartHour() == new_start){
+                matches.push_back(idSlots[it->second]);
             }
+        }
+        for (int slot : matches) {
+            replaceAt(slot, new_meeting);
+        }
+    }
 
-            // Removing all the meetings that aren't in the hours' interval specified
-            for (int i = 0; i < daily.current; ++i) {
-                if(daily.meetingList[i].getStartHour() < s_hour || daily.meetingList[i].getStartHour() > e_hour){
-                    daily.removeMeeting(daily.meetingList[i]);
-                }
-            }
+    /*! This function finds a free hour in a given time period and duration.
+     *  NOTE: Returns a meeting named "No free hour" if there is none */
+    Meeting findFreeHour(const MyDate& s_date, const MyDate& e_date, const MyHour& s_hour, const MyHour& e_hour,const MyHour& duration) const {
+        Meeting freeHour;
+        if(findFreeHours(&freeHour, 1, s_date, e_date, s_hour, e_hour, duration) == 1){
+            freeHour.setEndHour(freeHour.getStartHour() + duration);
+            return freeHour;
+        }
 
-            // Getting the first meeting for the day
-            Meeting previous = daily.meetingList[0];
-
-            // Checking if there is a free hour between s_hour and first meeting
-            if((previous.getStartHour() - s_hour) >= duration){
-                return Meeting((char*)"Free Hour",
-                               (char*)"This meeting contains free hour",
-                               s_date,
-                               s_hour,
-                               s_hour + duration
-                );
-            }
+        return {(char *) "No free hour",
+                (char *) "There is no free hour in this time period",
+                MyDate(),
+                MyHour(),
+                MyHour()
+        };
+    }
 
-            // Checking if there are free hours between meetings
-            for (int i = 0; i < daily.current; ++i) {
-                if((daily.getMeetingList()[i].getStartHour() - previous.getEndHour()) >= duration){
-                    return Meeting((char*)"Free Hour",
-                                   (char*)"This meeting contains free hour",
-                                   s_date,
-                                   previous.getEndHour(),
-                                   previous.getEndHour() + duration
-                                   );
+    /*! The same as findFreeHour() but the days are searched by many threads. The period is split into batches of
+     *  FREE_HOUR_BATCH_DAYS days and every thread takes the next batch in date order when it finishes one, so the
+     *  busy batches are shared between the threads. When a batch finds a free hour, the batches after it are skipped
+     *  and the ones that are already being searched stop. All batches before it are still searched, so the result
+     *  is always the earliest free hour, the same as findFreeHour(). The threads are started for every call,
+     *  so periods shorter than FREE_HOUR_PARALLEL_BATCHES batches are searched by findFreeHour() without them.
+     *  NOTE: Many threads pay off for long periods with mostly busy days. Throws invalid_argument if the period or the window is invalid */
+    Meeting findFreeHourParallel(const MyDate& s_date, const MyDate& e_date, const MyHour& s_hour, const MyHour& e_hour, const MyHour& duration,
+                                 unsigned threads = std::thread::hardware_concurrency()) const {
+        if(s_date > e_date || s_hour > e_hour) throw invalid_argument("The time range given to findFreeHour() is invalid");
+        int batches = (e_date.getSerial() - s_date.getSerial()) / FREE_HOUR_BATCH_DAYS + 1;
+        if(threads <= 1 || batches < FREE_HOUR_PARALLEL_BATCHES) return findFreeHour(s_date, e_date, s_hour, e_hour, duration);
+        threads = std::min(threads, (unsigned)batches);
+
+        std::atomic<int> next_batch(0);
+        // The first batch that found a free hour. Only batches before it are still worth searching
+        std::atomic<int> best_batch(INT_MAX);
+        std::vector<Meeting> found(batches);
+
+        auto search = [&](){
+            for (int batch = next_batch++; batch < batches && batch < best_batch.load(); batch = next_batch++) {
+                MyDate from = MyDate::fromSerial(s_date.getSerial() + batch * FREE_HOUR_BATCH_DAYS);
+                MyDate to = MyDate::fromSerial(std::min(e_date.getSerial(), from.getSerial() + FREE_HOUR_BATCH_DAYS - 1));
+                // The days of a batch are searched one at a time, so a thread stops soon after an earlier batch succeeds
+                for (MyDate date = from; batch < best_batch.load(); date.addDay()) {
+                    if(findFreeHours(&found[batch], 1, date, date, s_hour, e_hour, duration) == 1){
+                        int best = best_batch.load();
+                        while (batch < best && !best_batch.compare_exchange_weak(best, batch)) {}
+                        break;
+                    }
+                    if(date == to) break;
                 }
-                previous = daily.getMeetingList()[i];
-            }
-
-            // Checking if there is a free hour between last meeting and e_hour
-            if((e_hour - previous.getEndHour()) >= duration){
-                return Meeting((char*)"Free Hour",
-                               (char*)"This meeting contains free hour",
-                               s_date,
-                               previous.getEndHour(),
-                               previous.getEndHour() + duration
-                );
             }
-
-            // If no free hour is found we go to the next date
-            s_date.addDay();
+        };
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < threads; ++i) {
+            workers.emplace_back(search);
+        }
+        search();
+        for (std::thread& worker : workers) {
+            worker.join();
         }
 
+        if(best_batch.load() != INT_MAX){
+            Meeting freeHour = found[best_batch.load()];
+            freeHour.setEndHour(freeHour.getStartHour() + duration);
+            return freeHour;
+        }
         return {(char *) "No free hour",
                 (char *) "There is no free hour in this time period",
                 MyDate(),
@@ -398,47 +1151,161 @@ public:
         };
     }
 
-    /*! A function to make a busyness statistic and save it to a .txt file
-     *  The function accepts start and end date and in that interval sorts the day of the week
-     *  depending on the busyness. In the text file the hours are written as floats where the number after the
-     *  decimal point are the minutes*/
-    void workloadStatistic(MyDate s_date, MyDate e_date){
-        char* fileName = new char[25];
-        strcpy(fileName, "stats-");
-        strcat(fileName, s_date.getDateAsString());
-        strcat(fileName, ".txt");
+    /*! Finds the earliest time between s_hour and e_hour of the days in the period when all given calendars are free
+     *  for the given duration. The meetings of the period are taken from the date indexes of the calendars in one
+     *  k-way merge (a heap with the next meeting of every calendar), so they come in order of date and startHour
+     *  as if they were in one calendar, and the same sweep as in findFreeHours() finds the gaps. The cost is
+     *  about (meetings of all calendars up to the result) * log(number of calendars).
+     *  NOTE: Returns a meeting named "No free hour" if there is none. Throws invalid_argument if the period or the window is invalid */
+    static Meeting findCommonFreeHour(const std::vector<const PersonalCalendar*>& calendars, const MyDate& s_date, const MyDate& e_date,
+                                      const MyHour& s_hour, const MyHour& e_hour, const MyHour& duration){
+        if(s_date > e_date || s_hour > e_hour) throw invalid_argument("The time range given to findFreeHour() is invalid");
+        int window_start = s_hour.getTotalMinutes();
+        int window_end = e_hour.getTotalMinutes();
+        int length = std::max(duration.getTotalMinutes(), 1);
+        Meeting noFreeHour((char *) "No free hour", (char *) "There is no free hour in this time period", MyDate(), MyHour(), MyHour());
+        if(window_end - window_start < length) return noFreeHour;
+
+        auto freeHour = [&](int serial, int start){
+            return Meeting((char*)"Free Hour",
+                           (char*)"This meeting contains free hour",
+                           MyDate::fromSerial(serial),
+                           MyHour::fromMinutes(start),
+                           MyHour::fromMinutes(start + duration.getTotalMinutes()));
+        };
 
-        // Every element is a day of the week 0-Sunday, 1-Monday... etc.
-        float days_of_week_load[7];
+        // The heap keeps the sort key of the next meeting of every calendar, the smallest on top
+        std::vector<DateIndex::const_iterator> next, last;
+        std::priority_queue<std::pair<long long, int>, std::vector<std::pair<long long, int>>, std::greater<std::pair<long long, int>>> heap;
+        for (const PersonalCalendar* calendar : calendars) {
+            next.push_back(calendar->dateBegin(s_date));
+            last.push_back(calendar->dateEnd(e_date));
+            if(next.back() != last.back()) heap.push({next.back()->first, (int)next.size() - 1});
+        }
 
-        // Setting every value in the array to 0
-        for (int i = 0; i < 7; ++i) {
-            days_of_week_load[i] = 0;
+        int serial = s_date.getSerial();
+        int free_from = window_start;
+        while (!heap.empty()) {
+            long long key = heap.top().first;
+            int owner = heap.top().second;
+            heap.pop();
+            if(++next[owner] != last[owner]) heap.push({next[owner]->first, owner});
+
+            // Finishing the days before the meeting. A day without meetings has the whole window free
+            int date = (int)(key >> 22);
+            while (serial < date) {
+                if(window_end - free_from >= length) return freeHour(serial, free_from);
+                serial++;
+                free_from = window_start;
+            }
+
+            int start = (int)(key >> 11 & 2047);
+            int end = (int)(key & 2047);
+            // Meetings without length take no time and the ones after the window don't matter
+            if(end <= start || start >= window_end) continue;
+            if(start - free_from >= length) return freeHour(serial, free_from);
+            free_from = std::max(free_from, end);
         }
+        if(window_end - free_from >= length) return freeHour(serial, free_from);
+        if(serial < e_date.getSerial()) return freeHour(serial + 1, window_start);
+        return noFreeHour;
+    }
 
-        // Checking if the date is valid
-        if(s_date > e_date) throw invalid_argument("The time range given to workloadStatistic() is invalid");
+    /*! Puts the first count free intervals between s_hour and e_hour of the days in the period into freeList.
+     *  Every interval is at least duration long and is as long as possible, so it starts when a meeting
+     *  (or the window) starts being free and ends when the next meeting starts. Overlapping meetings are merged.
+     *  Days without meetings are not searched at all, so the cost depends on the meetings of the busy days.
+     *  NOTE: Returns the number of intervals. Throws invalid_argument if the period or the window is invalid */
+    int findFreeHours(Meeting* freeList, int count, const MyDate& s_date, const MyDate& e_date, const MyHour& s_hour, const MyHour& e_hour, const MyHour& duration) const {
+        if(s_date > e_date || s_hour > e_hour) throw invalid_argument("The time range given to findFreeHour() is invalid");
 
-        while (s_date <= e_date){
-            // Creating a new personal calendar containing only the meetings from the current date sorted
-            PersonalCalendar daily = getDailyProgram(s_date);
+        int window_start = s_hour.getTotalMinutes();
+        int window_end = e_hour.getTotalMinutes();
+        // A free interval is never empty, even if the duration is 0:00
+        int length = std::max(duration.getTotalMinutes(), 1);
+        // If the window cannot hold the duration no day can
+        if(window_end - window_start < length) return 0;
+
+        int found = 0;
+        auto addFree = [&](const MyDate& date, int start, int end){
+            freeList[found] = Meeting((char*)"Free Hour",
+                                      (char*)"This meeting contains free hour",
+                                      date,
+                                      MyHour::fromMinutes(start),
+                                      MyHour::fromMinutes(end));
+            found++;
+        };
 
-            // If the daily is empty that means the whole day is free, so we dont add anything
-            if(daily.current == 0){
-                s_date.addDay();
-                continue;
+        MyDate date = s_date;
+        if(occupancy.isEnabled()){
+            // The bitmaps already have the overlapping meetings merged, so only the free runs are visited
+            while (found < count){
+                occupancy.forEachFreeRun(date.getSerial(), window_start, window_end, length, [&](int start, int end){
+                    addFree(date, start, end);
+                    return found < count;
+                });
+                if(date == e_date) break;
+                date.addDay();
             }
+            return found;
+        }
 
-            // For every meeting we add the hours that are busy
-            for (int i = 0; i < daily.current; ++i) {
-                MyHour duration = daily.getMeetingList()[i].getEndHour() - daily.getMeetingList()[i].getStartHour();
-                float durInNum = duration.getHours() + 0.01*duration.getMinutes();
-                days_of_week_load[s_date.getDayOfWeek()] += durInNum;
+        auto it = dateBegin(s_date);
+        while (found < count){
+            long long next_day_key = Meeting::getDateKey(date) + (1 << 22);
+
+            // Sweeping the meetings of the day in order of startHour. The hours are read from the sort keys
+            int free_from = window_start;
+            for (; it != dateIndex.end() && it->first < next_day_key && found < count; ++it) {
+                int start = (int)(it->first >> 11 & 2047);
+                int end = (int)(it->first & 2047);
+                // Meetings without length take no time
+                if(end <= start) continue;
+                if(start >= window_end) break;
+                if(start - free_from >= length) addFree(date, free_from, start);
+                free_from = std::max(free_from, end);
             }
+            if(found < count && window_end - free_from >= length) addFree(date, free_from, window_end);
 
-            // Go to the next date
-            s_date.addDay();
+            // Going to the next day. If it has no meetings, the loop above does nothing and the whole window is free
+            if(date == e_date) break;
+            date.addDay();
+            if(it != dateIndex.end() && it->first < next_day_key) it = dateIndex.lower_bound({next_day_key, INT_MIN});
         }
+        return found;
+    }
+
+    /*! Puts the busy minutes of every day of the week between two dates (inclusive) into minutes.
+     *  minutes[0] is Sunday, minutes[1] is Monday and so on. The sums are kept up to date by every change,
+     *  so the cost does not depend on the number of meetings or the length of the period */
+    void getWorkload(const MyDate& s_date, const MyDate& e_date, long long minutes[7]) const {
+        if(s_date > e_date) throw invalid_argument("The time range given to getWorkload() is invalid");
+        workload.getWeekdayMinutes(s_date, e_date, minutes);
+    }
+
+    //! Returns the busy minutes of a single date
+    long long getWorkloadOfDate(const MyDate& date) const {
+        return workload.getDateMinutes(date);
+    }
+
+    /*! A function to make a busyness statistic and save it to a .txt file
+     *  The function accepts start and end date and in that interval sorts the day of the week
+     *  depending on the busyness. In the text file the time is written as hours and minutes (H:MM).
+     *  Days with the same busyness keep their order from Sunday to Saturday */
+    void workloadStatistic(const MyDate& s_date, const MyDate& e_date) const {
+        // The file name is stats-YYYY-MM-DD.txt
+        char fileName[32] = "stats-";
+        strcpy(s_date.formatTo(fileName + 6), ".txt");
+
+        // Every element is a day of the week 0-Sunday, 1-Monday... etc.
+        long long days_of_week_load[7];
+        getWorkload(s_date, e_date, days_of_week_load);
+
+        // Sorting the days of the week by their load
+        int indexes[7] = {0, 1, 2, 3, 4, 5, 6};
+        std::stable_sort(indexes, indexes + 7, [&](int a, int b){
+            return days_of_week_load[a] > days_of_week_load[b];
+        });
 
         // Opening the file to write the changes
         ofstream dateFile;
@@ -446,44 +1313,14 @@ public:
         dateFile.open (fileName);
         dateFile << "Workload statistic: days of week sorted by busyness\n";
 
-        // Creating array with the numbers of the days of week
-        int indexes[7];
-        for (int i = 0; i < 7; ++i) {
-            indexes[i] = i;
-        }
-
-        // Bubble sort for the two arrays at the same time
-        // This is needed because we need the day of the weeks to be sorted not the values
-        for(int i=0;i<7;i++){
-            for(int j=0;j<6-i;j++){
-                if(days_of_week_load[j]<days_of_week_load[j+1]){
-                    // Swapping elements in both arrays
-                    float temp=days_of_week_load[j+1];
-                    days_of_week_load[j+1]=days_of_week_load[j];
-                    days_of_week_load[j]=temp;
-
-                    int temp2=indexes[j+1];
-                    indexes[j+1]=indexes[j];
-                    indexes[j]=temp2;
-                }
-            }
-        }
-
         // Putting the data into the text file
+        static const char* const DAY_NAMES[7] = {"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"};
         for (int i = 0; i < 7; ++i) {
-            switch (indexes[i]) {
-                case 0: dateFile << "Sunday: " << days_of_week_load[i] << " hours" <<endl; break;
-                case 1: dateFile << "Monday: " << days_of_week_load[i] << " hours" <<endl; break;
-                case 2: dateFile << "Tuesday: " << days_of_week_load[i] << " hours" <<endl; break;
-                case 3: dateFile << "Wednesday: " << days_of_week_load[i] << " hours" <<endl; break;
-                case 4: dateFile << "Thursday: " << days_of_week_load[i] << " hours" <<endl; break;
-                case 5: dateFile << "Friday: " << days_of_week_load[i] << " hours" <<endl; break;
-                case 6: dateFile << "Saturday: " << days_of_week_load[i] << " hours" <<endl; break;
-            }
+            long long load = days_of_week_load[indexes[i]];
+            dateFile << DAY_NAMES[indexes[i]] << ": " << load / 60 << ":" << load % 60 / 10 << load % 10 << " hours" << endl;
         }
 
         dateFile.close();
-        delete [] fileName;
     }
 
     // SECTION: TESTS---------------------------------------------------------
@@ -565,6 +1402,25 @@ public:
         // Setting the current element number
         personalCalendar1.setCurrent(cur);
         personalCalendar1.print();
+
+        cout << "------------------------------------------------" << endl;
+        cout << "Getting all meetings with the whole word \"doctor\" in the description from the word index:" << endl;
+        PersonalCalendar personalCalendar3 = PersonalCalendar();
+        int tokens = personalCalendar.getAllByTokenInDescription(personalCalendar3.getMeetingList(), (char*)"doctor");
+        personalCalendar3.setCurrent(tokens);
+        personalCalendar3.print();
+
+        cout << "------------------------------------------------" << endl;
+        // The array is moved into new memory, so it can be used as a bigger buffer right away
+        personalCalendar3.setSize(50);
+        int all = personalCalendar.getAllByWordInDescription(personalCalendar3.getMeetingList(), (char*)"");
+        personalCalendar3.setCurrent(all);
+        cout << "Size after setSize(50): " << personalCalendar3.getSize() << ", meetings copied into it: " << personalCalendar3.getCurrent() << endl;
+        try {
+            personalCalendar3.setSize(5);
+        } catch (std::invalid_argument& e) {
+            cout << "setSize(5) failed: " << e.what() << endl;
+        }
     }
 
     /*! Test for adding and removing elements:
@@ -672,6 +1528,14 @@ public:
         cout << "#Calendar for 2022-10-22" << endl;
         PersonalCalendar calendarForTheDay = personalCalendar.getDailyProgram(MyDate(22, 10, 2022));
         calendarForTheDay.print();
+
+        cout << "#Meetings from 2022-10-22 to 2022-10-23 without copying them:" << endl;
+        const Meeting** program = new const Meeting*[personalCalendar.countInPeriod(MyDate(22, 10, 2022), MyDate(23, 10, 2022))];
+        int count = personalCalendar.getProgramForPeriod(program, MyDate(22, 10, 2022), MyDate(23, 10, 2022));
+        for (int i = 0; i < count; ++i) {
+            program[i]->print();
+        }
+        delete [] program;
     }
 
     /*! Test for save and load functionality
@@ -821,6 +1685,211 @@ public:
         freeHour3.print();
     }
 
+    /*! Test for the date index in sorted vectors:
+     *  - Turns the sorted vectors on and books meetings out of order
+     *  - Gets the meetings of a date, the earliest meeting and a free hour from the vectors */
+    static void sortedVectorDateIndexTest(){
+        PersonalCalendar personalCalendar = PersonalCalendar();
+        personalCalendar.setSortedVectorDateIndex(true);
+        personalCalendar.bookMeeting((char*) "Lunch", (char*)"", MyDate(23, 10, 2022), MyHour(12, 0), MyHour(13, 0));
+        personalCalendar.bookMeeting((char*) "Breakfast", (char*)"", MyDate(23, 10, 2022), MyHour(8, 0), MyHour(9, 0));
+        personalCalendar.bookMeeting((char*) "Dinner", (char*)"", MyDate(22, 10, 2022), MyHour(19, 0), MyHour(20, 0));
+        personalCalendar.removeMeetingByName((char*) "Dinner");
+
+        Meeting meetings[3];
+        int count = personalCalendar.getAllByDate(meetings, MyDate(23, 10, 2022));
+        cout << "Meetings on 2022-10-23 with the sorted vector date index:";
+        for (int i = 0; i < count; ++i) {
+            cout << " " << meetings[i].getName();
+        }
+        cout << endl;
+        cout << "Earliest meeting: " << personalCalendar.getEarliestMeeting().getName() << endl;
+        Meeting free_hour = personalCalendar.findFreeHour(MyDate(23, 10, 2022), MyDate(23, 10, 2022), MyHour(8, 0), MyHour(18, 0), MyHour(2, 0));
+        cout << "First free two hours start at ";
+        free_hour.getStartHour().print();
+        cout << endl;
+    }
+
+    /*! Test for the parallel free hour search:
+     *  - Books the whole working day of every day in 2022 except for a part of 28.10 and 30.10
+     *  - Finds the first free hour with four threads and with one */
+    static void parallelFreeHourTest(){
+        PersonalCalendar personalCalendar = PersonalCalendar();
+        for (MyDate date = MyDate(1, 1, 2022); date <= MyDate(31, 12, 2022); date.addDay()) {
+            if(date == MyDate(30, 10, 2022)) continue;
+            MyHour end = date == MyDate(28, 10, 2022) ? MyHour(15, 0) : MyHour(18, 0);
+            personalCalendar.bookMeeting((char*) "Work", (char*)"", date, MyHour(8, 0), end);
+        }
+        Meeting parallel = personalCalendar.findFreeHourParallel(MyDate(1, 1, 2022), MyDate(31, 12, 2022), MyHour(8, 0), MyHour(18, 0), MyHour(2, 0), 4);
+        Meeting serial = personalCalendar.findFreeHourParallel(MyDate(1, 1, 2022), MyDate(31, 12, 2022), MyHour(8, 0), MyHour(18, 0), MyHour(2, 0), 1);
+        cout << "First free two hours with four threads: " << endl;
+        parallel.print();
+        cout << "The same as with one thread: " << (parallel == serial ? "true" : "false") << endl;
+    }
+
+    /*! Test for the common free hour:
+     *  - Creates three calendars. Each of them is busy at a different part of 22.10.2022
+     *  - Finds the first hour when all three are free and the first two hours, which are on the next day */
+    static void commonFreeHourTest(){
+        PersonalCalendar first, second, third;
+        first.bookMeeting((char*) "Work", (char*)"", MyDate(22, 10, 2022), MyHour(8, 0), MyHour(12, 0));
+        second.bookMeeting((char*) "Lunch", (char*)"", MyDate(22, 10, 2022), MyHour(11, 30), MyHour(13, 0));
+        third.bookMeeting((char*) "Gym", (char*)"", MyDate(22, 10, 2022), MyHour(14, 0), MyHour(18, 0));
+        third.bookMeeting((char*) "Dentist", (char*)"", MyDate(23, 10, 2022), MyHour(8, 0), MyHour(9, 0));
+
+        std::vector<const PersonalCalendar*> calendars = {&first, &second, &third};
+        cout << "First common free hour: " << endl;
+        findCommonFreeHour(calendars, MyDate(22, 10, 2022), MyDate(30, 10, 2022), MyHour(8, 0), MyHour(18, 0), MyHour(1, 0)).print();
+        cout << "First common free two hours: " << endl;
+        findCommonFreeHour(calendars, MyDate(22, 10, 2022), MyDate(30, 10, 2022), MyHour(8, 0), MyHour(18, 0), MyHour(2, 0)).print();
+    }
+
+    /*! This function tests the findFreeHours():
+     *  - Creates personal calendar with two overlapping meetings, where the first one ends after the second one
+     *  - Finds the first 3 free intervals between 8:00 and 18:00 for two days */
+    static void freeHoursTest(){
+        PersonalCalendar personalCalendar = PersonalCalendar();
+        personalCalendar.bookMeeting((char*) "Long meeting", (char*)"", MyDate(23, 10, 2022), MyHour(9, 0), MyHour(14, 0));
+        personalCalendar.bookMeeting((char*) "Short meeting", (char*)"", MyDate(23, 10, 2022), MyHour(10, 0), MyHour(11, 0));
+        personalCalendar.bookMeeting((char*) "Evening meeting", (char*)"", MyDate(23, 10, 2022), MyHour(16, 0), MyHour(17, 0));
+
+        cout << "Free intervals for 2022-10-23 - 2022-10-24, 8:00 - 18:00 with duration 1:00:" << endl;
+        Meeting freeList[3];
+        int found = personalCalendar.findFreeHours(freeList, 3, MyDate(23, 10, 2022), MyDate(24, 10, 2022),
+                                                   MyHour(8, 0), MyHour(18, 0), MyHour(1, 0));
+        for (int i = 0; i < found; ++i) {
+            freeList[i].print();
+        }
+    }
+
+    /*! Test for the calendar file format:
+     *  - Saves a calendar in the old format and imports it into the new one
+     *  - Loads the new file into another calendar and prints it
+     *  - Changes one byte of the file and tries to load it again */
+    static void calendarFileTest(){
+        PersonalCalendar personalCalendar = PersonalCalendar();
+        personalCalendar.bookMeeting((char*) "Anime Convention 2", (char*)"Going to anime convention", MyDate(23, 10, 2022), MyHour(12, 0), MyHour(15, 0));
+        personalCalendar.bookMeeting((char*) "Anime Convention 1", (char*)"Going to anime convention", MyDate(22, 10, 2022), MyHour(12, 0), MyHour(15, 0));
+
+        ofstream legacy("PersonalCalendar.dat", ios::out | ios::binary);
+        if(!legacy){
+            throw invalid_argument("Couldn't open file");
+        }
+        personalCalendar.save(legacy);
+        legacy.close();
+
+        PersonalCalendar::importLegacy("PersonalCalendar.dat", "PersonalCalendar.pcal");
+        PersonalCalendar personalCalendar1 = PersonalCalendar();
+        personalCalendar1.loadFile("PersonalCalendar.pcal");
+        cout << "#Loads the imported calendar: -----------------------------------------------" << endl;
+        personalCalendar1.print();
+
+        fstream damaged("PersonalCalendar.pcal", ios::in | ios::out | ios::binary);
+        damaged.seekp(-2, ios::end);
+        damaged.put('?');
+        damaged.close();
+        try {
+            personalCalendar1.loadFile("PersonalCalendar.pcal");
+        } catch (std::invalid_argument& e) {
+            cout << "Loading the changed file: " << e.what() << endl;
+        }
+    }
+
+    /*! Test for the paged snapshot:
+     *  - Saves a calendar with meetings in three different months
+     *  - Changes one meeting, so only its page has to be written again
+     *  - Loads the snapshot into another calendar */
+    static void pagesTest(){
+        std::remove("Pages.pages");
+        PersonalCalendar personalCalendar = PersonalCalendar();
+        personalCalendar.bookMeeting((char*) "Anime Convention 1", (char*)"Going to anime convention", MyDate(22, 8, 2022), MyHour(9, 0), MyHour(15, 0));
+        personalCalendar.bookMeeting((char*) "Anime Convention 2", (char*)"Going to anime convention", MyDate(23, 10, 2022), MyHour(12, 0), MyHour(15, 0));
+        personalCalendar.bookMeeting((char*) "Anime Convention 3", (char*)"Going to anime convention", MyDate(24, 12, 2022), MyHour(17, 0), MyHour(20, 0));
+        personalCalendar.savePages("Pages");
+        cout << "Dirty pages after saving: " << personalCalendar.getDirtyPageCount() << endl;
+
+        personalCalendar.updateAllWithName((char*) "Anime Convention 2", Meeting((char*) "Anime Convention 2", (char*)"Moved", MyDate(23, 10, 2022), MyHour(13, 0), MyHour(16, 0)));
+        cout << "Dirty pages after one update: " << personalCalendar.getDirtyPageCount() << endl;
+        personalCalendar.savePages("Pages");
+
+        PersonalCalendar personalCalendar1 = PersonalCalendar();
+        personalCalendar1.loadPages("Pages");
+        cout << "#Loads the paged snapshot: -----------------------------------------------" << endl;
+        personalCalendar1.print();
+    }
+
+    /*! Test for the conflicts:
+     *  - Books three meetings where the first one overlaps with the other two
+     *  - Prints the conflicting pairs and groups
+     *  - Tries to book an overlapping meeting in strict mode */
+    static void conflictsTest(){
+        PersonalCalendar personalCalendar = PersonalCalendar();
+        personalCalendar.bookMeeting((char*) "Long meeting", (char*)"", MyDate(23, 10, 2022), MyHour(9, 0), MyHour(14, 0));
+        personalCalendar.bookMeeting((char*) "Short meeting", (char*)"", MyDate(23, 10, 2022), MyHour(10, 0), MyHour(11, 0));
+        personalCalendar.bookMeeting((char*) "Lunch", (char*)"", MyDate(23, 10, 2022), MyHour(13, 0), MyHour(15, 0));
+        personalCalendar.bookMeeting((char*) "Evening meeting", (char*)"", MyDate(23, 10, 2022), MyHour(16, 0), MyHour(17, 0));
+
+        std::vector<std::pair<long long, long long>> conflicts = personalCalendar.getConflicts(MyDate(23, 10, 2022), MyDate(23, 10, 2022));
+        cout << "Conflicting pairs:" << endl;
+        for (const std::pair<long long, long long>& conflict : conflicts) {
+            cout << personalCalendar.getById(conflict.first).getName() << " - " << personalCalendar.getById(conflict.second).getName() << endl;
+        }
+        std::vector<std::vector<long long>> clusters = personalCalendar.getConflictClusters(MyDate(23, 10, 2022), MyDate(23, 10, 2022));
+        cout << "Conflicting groups: " << clusters.size() << ", meetings in the first one: " << clusters[0].size() << endl;
+
+        try {
+            personalCalendar.bookMeeting((char*) "Late lunch", (char*)"", MyDate(23, 10, 2022), MyHour(14, 30), MyHour(16, 30), true);
+        } catch (std::invalid_argument& e) {
+            cout << "Strict booking failed: " << e.what() << endl;
+        }
+        personalCalendar.bookMeeting((char*) "Break", (char*)"", MyDate(23, 10, 2022), MyHour(15, 0), MyHour(16, 0), true);
+        cout << "Meetings after booking a break in strict mode: " << personalCalendar.getCurrent() << endl;
+    }
+
+    /*! Test for the meeting ids:
+     *  - Adds three meetings and keeps their ids
+     *  - Removes and updates meetings by id
+     *  - Checks that the id of a removed meeting is not valid after its place is used again */
+    static void idTest(){
+        PersonalCalendar personalCalendar = PersonalCalendar();
+        long long first = personalCalendar.addMeeting(Meeting((char*)"First", (char*)"", MyDate(22, 10, 2022), MyHour(9, 0), MyHour(10, 0)));
+        long long second = personalCalendar.addMeeting(Meeting((char*)"Second", (char*)"", MyDate(22, 10, 2022), MyHour(11, 0), MyHour(12, 0)));
+        long long third = personalCalendar.addMeeting(Meeting((char*)"Third", (char*)"", MyDate(23, 10, 2022), MyHour(9, 0), MyHour(10, 0)));
+
+        cout << "Removing the first meeting by id: " << (personalCalendar.removeById(first) ? "true" : "false") << endl;
+        cout << "Removing it again: " << (personalCalendar.removeById(first) ? "true" : "false") << endl;
+        personalCalendar.updateById(third, Meeting((char*)"Third updated", (char*)"", MyDate(24, 10, 2022), MyHour(9, 0), MyHour(10, 0)));
+        cout << "The third meeting is now: " << personalCalendar.getById(third).getName() << endl;
+        cout << "The second meeting is still: " << personalCalendar.getById(second).getName() << endl;
+
+        long long fourth = personalCalendar.addMeeting(Meeting((char*)"Fourth", (char*)"", MyDate(25, 10, 2022), MyHour(9, 0), MyHour(10, 0)));
+        cout << "The old id is valid again: " << (personalCalendar.containsId(first) ? "true" : "false") << endl;
+        cout << "The new id is valid: " << (personalCalendar.containsId(fourth) ? "true" : "false") << endl;
+
+        // Loading replaces all meetings, so the ids given out before must not match the loaded ones
+        PersonalCalendar saved = PersonalCalendar();
+        Meeting loaded_meeting((char*)"Loaded", (char*)"", MyDate(26, 10, 2022), MyHour(9, 0), MyHour(10, 0));
+        saved.addMeeting(loaded_meeting);
+        saved.addMeeting(Meeting((char*)"Loaded too", (char*)"", MyDate(27, 10, 2022), MyHour(9, 0), MyHour(10, 0)));
+        ofstream legacy("Ids.dat", ios::out | ios::binary);
+        saved.save(legacy);
+        legacy.close();
+        saved.saveFile("Ids.pcal");
+        std::remove("Ids.pages");
+        saved.savePages("Ids");
+
+        ifstream legacy_in("Ids.dat", ios::in | ios::binary);
+        personalCalendar.load(legacy_in);
+        cout << "Old ids after load(): " << (personalCalendar.removeById(second) || personalCalendar.removeById(fourth) ? "valid" : "not valid") << endl;
+        long long loaded = personalCalendar.findId(loaded_meeting);
+        personalCalendar.loadFile("Ids.pcal");
+        cout << "Old ids after loadFile(): " << (personalCalendar.removeById(second) || personalCalendar.removeById(loaded) ? "valid" : "not valid") << endl;
+        loaded = personalCalendar.findId(loaded_meeting);
+        personalCalendar.loadPages("Ids");
+        cout << "Old ids after loadPages(): " << (personalCalendar.removeById(second) || personalCalendar.removeById(loaded) ? "valid" : "not valid") << endl;
+        cout << "Meetings after the loads: " << personalCalendar.getCurrent() << endl;
+    }
+
     /*! This function tests the workloadStatistic():
      *  - Creates personal calendar with 3 meetings
      *  - Runs the workloadStatistic() function*/
@@ -861,6 +1930,9 @@ public:
 
 };
 
+// The journal and the concurrent calendar keep a PersonalCalendar, so they are included after the class
+#include "CalendarJournal.cpp"
+#include "ConcurrentCalendar.cpp"
 
 int main(){
 
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+/*! This is the list of meeting ids of one token in WordIndex or one trigram in TrigramIndex.
+ *  The ids are kept sorted in a single array, so a list costs 4 bytes per id and has no side table:
+ *  - an id is found by binary search
+ *  - a removed id is not erased but marked as removed (a tombstone), so removing costs log(n)
+ *  - when more than half of the array is tombstones, it is compacted in one pass, which is O(1) per removal on average
+ *  A tombstone keeps its place in the order, so a removed id that is added again is only unmarked */
+class PostingList{
+    //! VECTOR: The ids in increasing order. A removed id is kept as ~id (a negative number) until the next compaction
+    std::vector<int> entries;
+    //! INT: The number of tombstones in entries
+    int removed;
+
+    //! Returns the id of an entry, also of a tombstone
+    static int idOf(int entry){
+        return entry < 0 ? ~entry : entry;
+    }
+
+    //! Returns the first entry whose id is not smaller than the given one
+    std::vector<int>::const_iterator lowerBound(int id) const {
+        return std::lower_bound(entries.begin(), entries.end(), id, [](int entry, int value){
+            return idOf(entry) < value;
+        });
+    }
+
+    //! Drops all tombstones
+    void compact(){
+        entries.erase(std::remove_if(entries.begin(), entries.end(), [](int entry){
+            return entry < 0;
+        }), entries.end());
+        removed = 0;
+    }
+
+public:
+    // SECTION: CONSTRUCTORS------------------------------------------------------------------
+
+    //! Creates an empty list
+    PostingList() : removed(0){
+    }
+
+    // SECTION: GETTERS AND SETTERS-----------------------------------------------------------
+
+    //! Returns the number of ids
+    size_t size() const {
+        return entries.size() - removed;
+    }
+
+    //! Checks if the list has no ids
+    bool empty() const {
+        return size() == 0;
+    }
+
+    // SECTION: HELPER FUNCTIONS---------------------------------------------------------------
+
+    //! Checks if an id is in the list
+    bool contains(int id) const {
+        auto it = lowerBound(id);
+        return it != entries.end() && *it == id;
+    }
+
+    //! Adds an id. An id that is already in the list is not added again
+    void add(int id){
+        // New meetings get the biggest ids, so most ids go to the end
+        if(entries.empty() || idOf(entries.back()) < id){
+            entries.push_back(id);
+            return;
+        }
+        auto it = entries.begin() + (lowerBound(id) - entries.cbegin());
+        if(it != entries.end() && idOf(*it) == id){
+            if(*it < 0){
+                *it = id;
+                removed--;
+            }
+            return;
+        }
+        entries.insert(it, id);
+    }
+
+    //! Removes an id if it is in the list
+    void remove(int id){
+        auto it = entries.begin() + (lowerBound(id) - entries.cbegin());
+        if(it == entries.end() || *it != id) return;
+        *it = ~id;
+        removed++;
+        if((size_t)removed * 2 > entries.size()) compact();
+    }
+
+    //! Calls action(id) for every id in increasing order
+    template <typename Action>
+    void forEach(Action action) const {
+        for (int entry : entries) {
+            if(entry >= 0) action(entry);
+        }
+    }
+
+    //! Returns the smallest id. The list must not be empty
+    int smallest() const {
+        for (int entry : entries) {
+            if(entry >= 0) return entry;
+        }
+        return -1;
+    }
+
+    //! Returns the ids in increasing order
+    std::vector<int> sorted() const {
+        std::vector<int> result;
+        result.reserve(size());
+        forEach([&](int id){
+            result.push_back(id);
+        });
+        return result;
+    }
+
+    // SECTION: TESTS-------------------------------------------------------------------------
+
+    /*! Test for adding and removing ids:
+     *  - Adds ids in decreasing order, so every one goes to the front
+     *  - Removes the ids in the middle, which compacts the list on the way, and adds one of them again */
+    static void addAndRemoveTest(){
+        PostingList list;
+        for (int id = 40; id > 0; --id) {
+            list.add(id);
+        }
+        list.add(7);
+        for (int id = 5; id <= 35; ++id) {
+            list.remove(id);
+        }
+        list.add(20);
+
+        cout << "Ids left:";
+        for (int id : list.sorted()) {
+            cout << " " << id;
+        }
+        cout << endl;
+        cout << "Contains 36: " << (list.contains(36) ? "true" : "false") << ", contains 21: " << (list.contains(21) ? "true" : "false") << endl;
+    }
+};
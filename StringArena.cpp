@@ -0,0 +1,335 @@
+#include <iostream>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+#include <string.h>
+
+using namespace std;
+
+/*! This is a table of interned strings shared by all meetings. Every distinct string is kept only once
+ *  in large blocks of memory and the meetings refer to it with an int handle, so copying a meeting
+ *  copies two ints instead of allocating two new strings.
+ *  The strings are reference counted. The memory of the released ones is given back by compact().
+ *  The arena can be used from many threads. Looking strings up takes a shared lock, adding and removing them
+ *  takes an exclusive one, and retain() and get() take none: a thread that holds a handle also holds a reference,
+ *  so the string cannot go away under it. The only exception is compact(), see there */
+class StringArena{
+    //! A single interned string
+    struct Entry{
+        //! CHAR: The text of the string inside one of the blocks. nullptr for free entries
+        char* text;
+        //! INT: The length of the text without the terminating zero
+        int length;
+        //! INT: The number of handles that refer to this string. Changed without the lock by retain() and release()
+        std::atomic<int> references;
+        //! UNSIGNED: The hash of the text
+        unsigned hash;
+    };
+
+    //! INT: The size of a single block of text
+    static constexpr int BLOCK_SIZE = 64 * 1024;
+    //! INT: Marks a position in the hash table that was never used
+    static constexpr int EMPTY_SLOT = -1;
+    //! INT: Marks a position in the hash table that was used by a released string
+    static constexpr int REMOVED_SLOT = -2;
+    //! INT: The first chunk of entries holds 2^FIRST_CHUNK_BITS entries and every next one twice as many
+    static constexpr int FIRST_CHUNK_BITS = 10;
+    //! INT: The number of chunks. They are enough for every int handle
+    static constexpr int CHUNK_COUNT = 32 - FIRST_CHUNK_BITS;
+
+    //! SHARED_MUTEX: Guards the hash table, the blocks and the list of free entries
+    mutable std::shared_mutex lock;
+
+    //! VECTOR: All blocks of text owned by the arena
+    std::vector<char*> blocks;
+    //! CHAR: The block new strings are written to
+    char* currentBlock;
+    //! INT: The number of used chars in the current block
+    int currentUsed;
+    /*! ENTRY: All entries in chunks that grow twice every time. A chunk is never moved or freed before the arena,
+     *  so a thread can read an entry while another one adds new entries */
+    Entry* chunks[CHUNK_COUNT];
+    //! INT: The number of entries that were ever used
+    int entryCount;
+    //! VECTOR: Positions of released entries that can be used again
+    std::vector<int> freeEntries;
+    //! VECTOR: Open addressing hash table with linear probing. Keeps entry positions
+    std::vector<int> table;
+    //! INT: The number of positions in the table that are not EMPTY_SLOT
+    int tableUsed;
+    //! SIZE_T: The number of chars taken by live strings
+    size_t liveChars;
+    //! SIZE_T: The number of chars taken by released strings that compact() can give back
+    size_t garbageChars;
+
+    //! FNV-1a hash of a string with a given length
+    static unsigned hashOf(const char* text, int length){
+        unsigned hash = 2166136261u;
+        for (int i = 0; i < length; ++i) {
+            hash = (hash ^ (unsigned char)text[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    //! Returns the entry with the given handle
+    Entry& entryAt(int handle) const {
+        unsigned position = (unsigned)handle + (1u << FIRST_CHUNK_BITS);
+        int chunk = 31 - __builtin_clz(position) - FIRST_CHUNK_BITS;
+        return chunks[chunk][position - (1u << (chunk + FIRST_CHUNK_BITS))];
+    }
+
+    //! Adds a new entry at the end and returns its handle
+    int addEntry(){
+        unsigned position = (unsigned)entryCount + (1u << FIRST_CHUNK_BITS);
+        int chunk = 31 - __builtin_clz(position) - FIRST_CHUNK_BITS;
+        if(chunks[chunk] == nullptr) chunks[chunk] = new Entry[(size_t)1 << (chunk + FIRST_CHUNK_BITS)];
+        return entryCount++;
+    }
+
+    /*! Looks for a string in the hash table and adds a reference to it. The lock has to be held (shared is enough).
+     *  NOTE: Returns -1 if the string is not in the arena */
+    int findAndRetain(const char* text, int length, unsigned hash) const {
+        if(table.empty()) return -1;
+        size_t mask = table.size() - 1;
+        for (size_t i = hash & mask; table[i] != EMPTY_SLOT; i = (i + 1) & mask) {
+            if(table[i] < 0) continue;
+            Entry& entry = entryAt(table[i]);
+            if(entry.hash == hash && entry.length == length && memcmp(entry.text, text, length) == 0){
+                entry.references.fetch_add(1, std::memory_order_relaxed);
+                return table[i];
+            }
+        }
+        return -1;
+    }
+
+    //! Copies a string with its terminating zero into the blocks and returns where it was put
+    char* store(const char* text, int length){
+        // Strings that don't fit in a block get a block of their own
+        if(length + 1 > BLOCK_SIZE){
+            char* big = new char[length + 1];
+            blocks.push_back(big);
+            memcpy(big, text, length + 1);
+            return big;
+        }
+        if(currentBlock == nullptr || currentUsed + length + 1 > BLOCK_SIZE){
+            currentBlock = new char[BLOCK_SIZE];
+            blocks.push_back(currentBlock);
+            currentUsed = 0;
+        }
+        char* place = currentBlock + currentUsed;
+        memcpy(place, text, length + 1);
+        currentUsed += length + 1;
+        return place;
+    }
+
+    //! Puts an entry position into the hash table. The table has to have a free position
+    void insertIntoTable(int handle){
+        size_t mask = table.size() - 1;
+        size_t i = entryAt(handle).hash & mask;
+        while (table[i] >= 0) {
+            i = (i + 1) & mask;
+        }
+        if(table[i] == EMPTY_SLOT) tableUsed++;
+        table[i] = handle;
+    }
+
+    //! Makes the hash table big enough for one more string and clears the removed positions
+    void reserveTable(){
+        if(!table.empty() && (tableUsed + 1) * 10 < (int)table.size() * 7) return;
+
+        size_t new_size = table.empty() ? 64 : table.size();
+        while ((entryCount - freeEntries.size() + 1) * 10 >= new_size * 5) new_size *= 2;
+
+        table.assign(new_size, EMPTY_SLOT);
+        tableUsed = 0;
+        for (int i = 0; i < entryCount; ++i) {
+            if(entryAt(i).text != nullptr) insertIntoTable(i);
+        }
+    }
+
+    //! Adds a string that is not in the arena yet with one reference. The exclusive lock has to be held
+    int insert(const char* text, int length, unsigned hash){
+        reserveTable();
+        int handle;
+        if(!freeEntries.empty()){
+            handle = freeEntries.back();
+            freeEntries.pop_back();
+        } else {
+            handle = addEntry();
+        }
+        Entry& entry = entryAt(handle);
+        entry.text = store(text, length);
+        entry.length = length;
+        entry.references.store(1, std::memory_order_relaxed);
+        entry.hash = hash;
+        liveChars += length + 1;
+        insertIntoTable(handle);
+        return handle;
+    }
+
+public:
+    // SECTION: CONSTRUCTORS------------------------------------------------------------------
+
+    //! Creates an empty arena. The empty string always has handle 0 and is never released
+    StringArena() : currentBlock(nullptr), currentUsed(0), chunks(), entryCount(0), tableUsed(0), liveChars(0), garbageChars(0){
+        insert("", 0, hashOf("", 0));
+    }
+
+    //! The arena owns raw memory, so it cannot be copied
+    StringArena(const StringArena &other) = delete;
+    StringArena& operator = (const StringArena& rhs) = delete;
+
+    //! Destructor for the StringArena class
+    ~StringArena() {
+        for (char* block : blocks) {
+            delete [] block;
+        }
+        for (Entry* chunk : chunks) {
+            delete [] chunk;
+        }
+    }
+
+    //! Returns the arena used by all meetings
+    static StringArena& shared(){
+        static StringArena arena;
+        return arena;
+    }
+
+    // SECTION: HELPER FUNCTIONS---------------------------------------------------------------
+
+    /*! Returns a handle to the given string with one more reference to it.
+     *  If the same text is already in the arena it is reused, otherwise it is copied into a block */
+    int intern(const char* text){
+        // The empty string is not reference counted
+        if(text[0] == '\0') return 0;
+
+        int length = (int)strlen(text);
+        unsigned hash = hashOf(text, length);
+
+        // Most strings are already in the arena, so many threads can find them at the same time
+        {
+            std::shared_lock<std::shared_mutex> guard(lock);
+            int handle = findAndRetain(text, length, hash);
+            if(handle >= 0) return handle;
+        }
+
+        // Another thread could add the string before the exclusive lock is taken, so it is looked for again
+        std::unique_lock<std::shared_mutex> guard(lock);
+        int handle = findAndRetain(text, length, hash);
+        if(handle >= 0) return handle;
+        return insert(text, length, hash);
+    }
+
+    //! Returns the handle of a string without adding a reference to it or -1 if the string is not in the arena
+    int find(const char* text) const {
+        int length = (int)strlen(text);
+        unsigned hash = hashOf(text, length);
+        std::shared_lock<std::shared_mutex> guard(lock);
+        size_t mask = table.size() - 1;
+        for (size_t i = hash & mask; table[i] != EMPTY_SLOT; i = (i + 1) & mask) {
+            if(table[i] < 0) continue;
+            const Entry& entry = entryAt(table[i]);
+            if(entry.hash == hash && entry.length == length && memcmp(entry.text, text, length) == 0){
+                return table[i];
+            }
+        }
+        return -1;
+    }
+
+    //! Adds one more reference to the string with the given handle
+    void retain(int handle){
+        if(handle == 0) return;
+        entryAt(handle).references.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //! Removes one reference to the string with the given handle. The string is released after the last one
+    void release(int handle){
+        if(handle == 0) return;
+        Entry& entry = entryAt(handle);
+        if(entry.references.fetch_sub(1, std::memory_order_acq_rel) > 1) return;
+
+        // Before the lock is taken intern() can find the string again, or another thread can release it first
+        std::unique_lock<std::shared_mutex> guard(lock);
+        if(entry.references.load(std::memory_order_relaxed) > 0 || entry.text == nullptr) return;
+
+        // Removing the entry from the table
+        size_t mask = table.size() - 1;
+        size_t i = entry.hash & mask;
+        while (table[i] != handle) {
+            i = (i + 1) & mask;
+        }
+        table[i] = REMOVED_SLOT;
+
+        liveChars -= entry.length + 1;
+        garbageChars += entry.length + 1;
+        entry.text = nullptr;
+        freeEntries.push_back(handle);
+    }
+
+    /*! Returns the text of a string. NOTE: The pointer is valid until the string is released
+     *  or compact() is called */
+    char* get(int handle) const {
+        return entryAt(handle).text;
+    }
+
+    //! Returns the length of a string
+    int length(int handle) const {
+        return entryAt(handle).length;
+    }
+
+    //! Returns the number of chars taken by released strings
+    size_t getGarbage() const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return garbageChars;
+    }
+
+    //! Returns the number of chars taken by live strings
+    size_t getLive() const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return liveChars;
+    }
+
+    /*! Moves all live strings into new blocks and frees the old ones. The handles stay the same.
+     *  This is maintenance for the whole process, because the arena is shared by the meetings of every calendar.
+     *  Call it on shared() after removing many meetings, at a point where no other thread uses any meeting.
+     *  NOTE: All pointers returned by get() before the call become invalid. get() does not lock,
+     *  so a thread that reads the strings of any meeting of any calendar while it runs reads freed memory */
+    void compact(){
+        std::unique_lock<std::shared_mutex> guard(lock);
+        std::vector<char*> old_blocks;
+        old_blocks.swap(blocks);
+        currentBlock = nullptr;
+        currentUsed = 0;
+
+        for (int i = 0; i < entryCount; ++i) {
+            Entry& entry = entryAt(i);
+            if(entry.text != nullptr) entry.text = store(entry.text, entry.length);
+        }
+        for (char* block : old_blocks) {
+            delete [] block;
+        }
+        garbageChars = 0;
+    }
+
+    // SECTION: TESTS-------------------------------------------------------------------------
+
+    /*! Test for interning and compaction:
+     *  - Interns the same text twice and checks that it gets the same handle
+     *  - Releases a string and compacts the arena */
+    static void internAndCompactTest(){
+        StringArena arena;
+        int first = arena.intern("Appointment");
+        int second = arena.intern("Appointment");
+        int other = arena.intern("Appointment with the doctor");
+        cout << "Same handle for the same text: " << ((first == second) ? "true" : "false") << endl;
+
+        arena.release(first);
+        arena.release(second);
+        cout << "Garbage after releasing \"Appointment\": " << arena.getGarbage() << endl;
+
+        arena.compact();
+        cout << "Garbage after compact: " << arena.getGarbage() << endl;
+        cout << "The other string is still: " << arena.get(other) << endl;
+    }
+};
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <string.h>
+
+using namespace std;
+
+/*! This is an index from every three consecutive chars (trigram) of a text to the ids of the meetings
+ *  that contain them. A word can be inside a text only if all of its trigrams are, so intersecting their
+ *  posting lists narrows the search down to a few candidates. The candidates still have to be checked
+ *  with strstr, because the trigrams may be in the text in a different order */
+class TrigramIndex{
+    //! MAP: The posting list of every trigram. The three chars are packed in the lower 24 bits
+    std::unordered_map<uint32_t, PostingList> postings;
+
+    //! Packs the three chars starting at text into a single key
+    static uint32_t trigramAt(const char* text){
+        return (uint32_t)(unsigned char)text[0] << 16 | (uint32_t)(unsigned char)text[1] << 8 | (unsigned char)text[2];
+    }
+
+public:
+    //! INT: Words shorter than this have no trigrams and cannot be looked up in the index
+    static constexpr int MIN_WORD_LENGTH = 3;
+
+    // SECTION: HELPER FUNCTIONS---------------------------------------------------------------
+
+    //! Adds the meeting id to the posting lists of all trigrams in the text
+    void add(int id, const char* text){
+        int length = (int)strlen(text);
+        for (int i = 0; i + MIN_WORD_LENGTH <= length; ++i) {
+            // A trigram that is repeated in the text is added only once
+            postings[trigramAt(text + i)].add(id);
+        }
+    }
+
+    //! Removes the meeting id from the posting lists of all trigrams in the text
+    void remove(int id, const char* text){
+        int length = (int)strlen(text);
+        for (int i = 0; i + MIN_WORD_LENGTH <= length; ++i) {
+            auto found = postings.find(trigramAt(text + i));
+            if(found == postings.end()) continue;
+            found->second.remove(id);
+            if(found->second.empty()) postings.erase(found);
+        }
+    }
+
+    //! Removes all trigrams from the index
+    void clear(){
+        postings.clear();
+    }
+
+    /*! Puts the sorted ids of the meetings whose text may contain the word into candidates.
+     *  The shortest posting list is checked against the others, so the work depends on the rarest trigram.
+     *  NOTE: Returns false if the word is shorter than MIN_WORD_LENGTH and the index cannot help */
+    bool findCandidates(const char* word, std::vector<int>& candidates) const {
+        candidates.clear();
+        int length = (int)strlen(word);
+        if(length < MIN_WORD_LENGTH) return false;
+
+        // Collecting the posting lists of all trigrams in the word
+        std::vector<const PostingList*> lists;
+        for (int i = 0; i + MIN_WORD_LENGTH <= length; ++i) {
+            auto found = postings.find(trigramAt(word + i));
+            // If a trigram is in no text, the word is in no text either
+            if(found == postings.end()) return true;
+            lists.push_back(&found->second);
+        }
+        std::sort(lists.begin(), lists.end(), [](const PostingList* a, const PostingList* b){
+            return a->size() < b->size();
+        });
+
+        // Intersecting the lists starting from the shortest one
+        candidates = lists[0]->sorted();
+        for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+            if(lists[i] == lists[i - 1]) continue;
+            const PostingList& list = *lists[i];
+            candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](int id){
+                return !list.contains(id);
+            }), candidates.end());
+        }
+        return true;
+    }
+
+    // SECTION: TESTS-------------------------------------------------------------------------
+
+    /*! Test for the candidates of a word:
+     *  - "with" has to find both "with" and "without"
+     *  - "sugar" has to find only one text
+     *  - "it" is too short for the index */
+    static void candidatesTest(){
+        TrigramIndex index;
+        index.add(1, "Appointment with the doctor");
+        index.add(2, "Coffee without sugar");
+        index.add(3, "Lunch");
+
+        std::vector<int> candidates;
+        index.findCandidates("with", candidates);
+        cout << "Candidates for \"with\": " << candidates.size() << endl;
+        index.findCandidates("sugar", candidates);
+        cout << "Candidates for \"sugar\": " << candidates.size() << endl;
+        cout << "Can \"it\" use the index: " << (index.findCandidates("it", candidates) ? "true" : "false") << endl;
+    }
+};
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <string.h>
+
+using namespace std;
+
+/*! This is an inverted index from the words of a text to the ids of the meetings that contain them.
+ *  A word (token) is a continuous sequence of letters, digits and non-ASCII chars, so "Appointment with
+ *  the doctor" has the tokens "Appointment", "with", "the" and "doctor". The tokens are case sensitive.
+ *  Every token keeps a sorted PostingList of ids, so removing a text costs log(n) per token (see PostingList) and a token
+ *  query costs as much as its posting list */
+class WordIndex{
+    //! MAP: The posting list of every token
+    std::unordered_map<std::string, PostingList> postings;
+
+    //! Checks if a char can be a part of a token
+    static bool isTokenChar(char c){
+        return isalnum((unsigned char)c) || (unsigned char)c >= 128;
+    }
+
+    //! Calls action(token) for every token in a text
+    template <typename Action>
+    static void forEachToken(const char* text, Action action){
+        std::string token;
+        while (*text != '\0') {
+            while (*text != '\0' && !isTokenChar(*text)) text++;
+            const char* start = text;
+            while (*text != '\0' && isTokenChar(*text)) text++;
+            if(text != start){
+                token.assign(start, text - start);
+                action(token);
+            }
+        }
+    }
+
+public:
+    // SECTION: HELPER FUNCTIONS---------------------------------------------------------------
+
+    //! Adds the meeting id to the posting lists of all tokens in the text
+    void add(int id, const char* text){
+        forEachToken(text, [&](const std::string& token){
+            // A token that is repeated in the text is added only once
+            postings[token].add(id);
+        });
+    }
+
+    //! Removes the meeting id from the posting lists of all tokens in the text
+    void remove(int id, const char* text){
+        forEachToken(text, [&](const std::string& token){
+            auto found = postings.find(token);
+            if(found == postings.end()) return;
+            found->second.remove(id);
+            if(found->second.empty()) postings.erase(found);
+        });
+    }
+
+    //! Removes all tokens from the index
+    void clear(){
+        postings.clear();
+    }
+
+    /*! Returns the sorted ids of the meetings that contain the given token.
+     *  NOTE: Returns nullptr if there are none. The list is valid until the index is changed */
+    const PostingList* find(const char* token) const {
+        auto found = postings.find(token);
+        if(found == postings.end()) return nullptr;
+        return &found->second;
+    }
+
+    //! Returns the number of different tokens in the index
+    int getTokenCount() const {
+        return (int)postings.size();
+    }
+
+    // SECTION: TESTS-------------------------------------------------------------------------
+
+    /*! Test for adding and removing texts:
+     *  - Adds two texts with a common word
+     *  - Removes one of them and looks for the common word again */
+    static void addAndRemoveTest(){
+        WordIndex index;
+        index.add(1, "Appointment with the doctor");
+        index.add(2, "Lunch with Ivan, Maria and the team");
+
+        const PostingList* with = index.find("with");
+        cout << "Meetings with the word \"with\": " << (with == nullptr ? 0 : with->size()) << endl;
+
+        index.remove(1, "Appointment with the doctor");
+        with = index.find("with");
+        cout << "After removing meeting 1: " << (with == nullptr ? 0 : with->size()) << endl;
+        cout << "Meeting with \"doctor\" found: " << (index.find("doctor") != nullptr ? "true" : "false") << endl;
+    }
+};
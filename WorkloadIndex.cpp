@@ -0,0 +1,206 @@
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+/*! This is a running total of the busy minutes of the calendar. It keeps the minutes of every date and
+ *  one Fenwick tree (binary indexed tree) for every day of the week, so the minutes of a day of the week
+ *  over any period are the difference of two prefix sums. Dates with the same day of the week are 7 days
+ *  apart, so tree r keeps the dates whose serial number gives remainder r when divided by 7 at position serial / 7.
+ *  The trees are sparse hash maps, because only the positions on the paths of used dates are ever touched */
+class WorkloadIndex{
+    //! INT: The number of positions in every tree
+    static constexpr int TREE_SIZE = MyDate::MAX_SERIAL / 7 + 1;
+
+    //! MAP: The Fenwick trees of the seven remainders. Position p is kept at key p + 1
+    std::unordered_map<int, long long> trees[7];
+    //! MAP: The busy minutes of every date with meetings, found by the serial number of the date
+    std::unordered_map<int, long long> dateMinutes;
+
+    //! Adds minutes to the position of a date in its tree
+    void addToTree(int serial, long long minutes){
+        std::unordered_map<int, long long>& tree = trees[serial % 7];
+        for (int i = serial / 7 + 1; i <= TREE_SIZE; i += i & -i) {
+            long long& value = tree[i];
+            value += minutes;
+            if(value == 0) tree.erase(i);
+        }
+    }
+
+    //! Returns the minutes of all dates up to the given serial (inclusive) with the given remainder
+    long long prefix(int remainder, int serial) const {
+        if(serial < remainder) return 0;
+        const std::unordered_map<int, long long>& tree = trees[remainder];
+        long long sum = 0;
+        for (int i = (serial - remainder) / 7 + 1; i > 0; i -= i & -i) {
+            auto found = tree.find(i);
+            if(found != tree.end()) sum += found->second;
+        }
+        return sum;
+    }
+
+    /*! Builds the tree of a remainder from the minutes of its dates in one ordered pass. Every position
+     *  gives its sum to its parent after all its children gave theirs, so nothing is walked twice */
+    void buildTree(int remainder){
+        std::map<int, long long> positions;
+        for (const std::pair<const int, long long>& date : dateMinutes) {
+            if(date.first % 7 == remainder) positions[date.first / 7 + 1] += date.second;
+        }
+        std::unordered_map<int, long long>& tree = trees[remainder];
+        tree.clear();
+        tree.reserve(positions.size() * 2);
+        for (auto it = positions.begin(); it != positions.end(); ++it) {
+            int parent = it->first + (it->first & -it->first);
+            if(parent <= TREE_SIZE) positions[parent] += it->second;
+            if(it->second != 0) tree[it->first] = it->second;
+        }
+    }
+
+public:
+    // SECTION: HELPER FUNCTIONS---------------------------------------------------------------
+
+    /*! Replaces all minutes with the ones of count meetings. minutesOf(i, serial, minutes) gives the date and the
+     *  minutes of meeting i. The meetings are split between threads that sum the minutes of their dates,
+     *  the sums are merged, and every tree is built by its own thread.
+     *  The result is the same as adding the meetings one by one, only faster for many meetings */
+    template <typename MinutesOf>
+    void build(int count, MinutesOf minutesOf, unsigned threads = std::thread::hardware_concurrency()){
+        clear();
+        // Small calendars are not worth starting threads for
+        threads = std::max(1u, std::min(threads, (unsigned)(count / 4096 + 1)));
+
+        std::vector<std::unordered_map<int, long long>> partial(threads);
+        auto sumPart = [&](unsigned part){
+            int from = (int)((long long)count * part / threads);
+            int to = (int)((long long)count * (part + 1) / threads);
+            for (int i = from; i < to; ++i) {
+                int serial = 0;
+                long long minutes = 0;
+                minutesOf(i, serial, minutes);
+                if(minutes != 0) partial[part][serial] += minutes;
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned part = 1; part < threads; ++part) {
+            workers.emplace_back(sumPart, part);
+        }
+        sumPart(0);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        dateMinutes.swap(partial[0]);
+        for (unsigned part = 1; part < threads; ++part) {
+            for (const std::pair<const int, long long>& date : partial[part]) {
+                dateMinutes[date.first] += date.second;
+            }
+        }
+        for (auto it = dateMinutes.begin(); it != dateMinutes.end(); ) {
+            if(it->second == 0) it = dateMinutes.erase(it);
+            else ++it;
+        }
+
+        if(threads == 1){
+            for (int remainder = 0; remainder < 7; ++remainder) {
+                buildTree(remainder);
+            }
+            return;
+        }
+        workers.clear();
+        for (int remainder = 0; remainder < 7; ++remainder) {
+            workers.emplace_back(&WorkloadIndex::buildTree, this, remainder);
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    //! Adds the minutes of a meeting to its date. Negative minutes take them away
+    void add(const MyDate& date, long long minutes){
+        if(minutes == 0) return;
+        int serial = date.getSerial();
+        long long& value = dateMinutes[serial];
+        value += minutes;
+        if(value == 0) dateMinutes.erase(serial);
+        addToTree(serial, minutes);
+    }
+
+    //! Removes all minutes
+    void clear(){
+        for (std::unordered_map<int, long long>& tree : trees) {
+            tree.clear();
+        }
+        dateMinutes.clear();
+    }
+
+    //! Returns the busy minutes of a single date
+    long long getDateMinutes(const MyDate& date) const {
+        auto found = dateMinutes.find(date.getSerial());
+        return found == dateMinutes.end() ? 0 : found->second;
+    }
+
+    /*! Puts the busy minutes of every day of the week between two dates (inclusive) into minutes.
+     *  minutes[0] is Sunday, minutes[1] is Monday and so on, like MyDate::getDayOfWeek() */
+    void getWeekdayMinutes(const MyDate& s_date, const MyDate& e_date, long long minutes[7]) const {
+        for (int remainder = 0; remainder < 7; ++remainder) {
+            // Serial 0 (0001-01-01) is a Monday, so remainder r is the day of the week (r + 1) % 7
+            minutes[(remainder + 1) % 7] = prefix(remainder, e_date.getSerial()) - prefix(remainder, s_date.getSerial() - 1);
+        }
+    }
+
+    // SECTION: TESTS-------------------------------------------------------------------------
+
+    /*! Test for the weekday sums:
+     *  - Adds minutes to three Saturdays and one Sunday
+     *  - Gets the minutes of a period that contains only two of the Saturdays and the Sunday
+     *  - Takes the minutes of the Sunday away again */
+    static void weekdaySumsTest(){
+        WorkloadIndex index;
+        index.add(MyDate(15, 10, 2022), 60);
+        index.add(MyDate(22, 10, 2022), 90);
+        index.add(MyDate(29, 10, 2022), 30);
+        index.add(MyDate(23, 10, 2022), 45);
+
+        long long minutes[7];
+        index.getWeekdayMinutes(MyDate(16, 10, 2022), MyDate(29, 10, 2022), minutes);
+        cout << "Saturday minutes from 2022-10-16 to 2022-10-29: " << minutes[6] << endl;
+        cout << "Sunday minutes from 2022-10-16 to 2022-10-29: " << minutes[0] << endl;
+
+        index.add(MyDate(23, 10, 2022), -45);
+        index.getWeekdayMinutes(MyDate(16, 10, 2022), MyDate(29, 10, 2022), minutes);
+        cout << "Sunday minutes after removing the meeting: " << minutes[0] << endl;
+        cout << "Minutes of 2022-10-22: " << index.getDateMinutes(MyDate(22, 10, 2022)) << endl;
+    }
+
+    /*! Test for building the sums at once:
+     *  - Adds the minutes of 100000 meetings one by one to one index and builds another one from them with four threads
+     *  - Compares the weekday sums of both over a few periods */
+    static void buildTest(){
+        const int count = 100000;
+        auto minutesOf = [](int i, int& serial, long long& minutes){
+            serial = MyDate(1, 1, 2000).getSerial() + (int)((i * 7919LL) % 7300);
+            minutes = 15 + i % 120;
+        };
+        WorkloadIndex added, built;
+        for (int i = 0; i < count; ++i) {
+            int serial = 0;
+            long long minutes = 0;
+            minutesOf(i, serial, minutes);
+            added.add(MyDate::fromSerial(serial), minutes);
+        }
+        built.build(count, minutesOf, 4);
+
+        bool same = true;
+        long long first[7], second[7];
+        for (int year = 2000; year < 2020; year += 3) {
+            added.getWeekdayMinutes(MyDate(1, 3, year), MyDate(28, 2, year + 2), first);
+            built.getWeekdayMinutes(MyDate(1, 3, year), MyDate(28, 2, year + 2), second);
+            same = same && std::equal(first, first + 7, second);
+        }
+        cout << "Built sums are the same as added ones: " << (same ? "true" : "false") << endl;
+    }
+};